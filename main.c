@@ -10,7 +10,7 @@ int main()
 	int out[2000];
 	for(i=0;i<2000;i++)
 		in[i] = i;
-	struct rte_ring* r = rte_ring_create(pbuf,bufsize,sizeof(int));
+	struct rte_ring* r = rte_ring_create(pbuf,bufsize,sizeof(int),0);
 	int ret = 0;
 	printf("%p\n",pbuf);
 	printf("queue size:%d\n",r->size);
@@ -25,10 +25,12 @@ int main()
 	}
 	for(i=0;i<1500;i++)
 	{
-		rte_ring_dequeue_bulk(r, out + i,1);
-		printf("queue available:%d\n",(r->capacity - *r->prod_head + *r->cons_tail)%r->capacity);
+		rte_ring_dequeue_bulk(r, out + i,1,NULL);
+		printf("queue available:%" RTE_RING_PRIidx "\n",(r->capacity - *r->prod_head + *r->cons_tail)%r->capacity);
 	}
-	printf("prod_head:%d, prod_tail:%d, cons_head:%d, cons_tail:%d\n",*r->prod_head,*r->prod_tail,*r->cons_head,*r->cons_tail);
+	printf("prod_head:%" RTE_RING_PRIidx ", prod_tail:%" RTE_RING_PRIidx
+		", cons_head:%" RTE_RING_PRIidx ", cons_tail:%" RTE_RING_PRIidx "\n",
+		*r->prod_head,*r->prod_tail,*r->cons_head,*r->cons_tail);
 
 	return 0;
 }
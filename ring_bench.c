@@ -0,0 +1,372 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+/*
+ * Throughput and latency benchmark of rte_ring, printing JSON on stdout.
+ *
+ *   gcc -O2 -pthread -o ring_bench ring_bench.c
+ *   ./ring_bench [-n ops] [-t max_threads] [-l latency_samples] [-L label]
+ *
+ * Throughput runs SPSC and MPMC rings over burst sizes and element sizes,
+ * MPMC both with the head/tail engine and with RING_F_SLOT_SEQ;
+ * latency is the round trip of one object between two threads pinned on
+ * different cores, and between two processes sharing the buffer. Pass the
+ * commit id as the label, of [A-Za-z0-9._-], to track regressions.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "rte_ring.h"
+
+#define BENCH_RING_SLOTS 1024
+#define BENCH_MAX_BURST 256
+#define BENCH_MAX_ELEM 1024
+
+static const unsigned int bursts[] = { 1, 8, 32, 256 };
+static const unsigned int elem_sizes[] = { 4, 16, 64, 256, 1024 };
+
+static unsigned long ops = 1UL << 20;
+static unsigned int max_threads = 4;
+static unsigned int lat_samples = 100000;
+static const char *label = "";
+static int ncpu;
+static int first_result = 1;
+
+struct bench_ctx {
+	struct rte_ring *r;
+	unsigned int burst;
+	volatile unsigned long consumed;
+	pthread_barrier_t start;
+};
+
+struct bench_thread {
+	struct bench_ctx *ctx;
+	pthread_t tid;
+	unsigned int cpu;
+	unsigned long count;
+};
+
+static uint64_t
+now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+pin(unsigned int cpu)
+{
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu % ncpu, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void *
+producer(void *arg)
+{
+	struct bench_thread *t = (struct bench_thread *)arg;
+	struct bench_ctx *ctx = t->ctx;
+	static __thread char objs[BENCH_MAX_BURST * BENCH_MAX_ELEM];
+	unsigned long done = 0;
+	unsigned int n;
+
+	pin(t->cpu);
+	pthread_barrier_wait(&ctx->start);
+	while (done < t->count) {
+		n = ctx->burst;
+		if (n > t->count - done)
+			n = t->count - done;
+		n = rte_ring_enqueue_burst(ctx->r, objs, n, NULL);
+		if (n == 0)
+			_mm_pause();
+		done += n;
+	}
+	return NULL;
+}
+
+static void *
+consumer(void *arg)
+{
+	struct bench_thread *t = (struct bench_thread *)arg;
+	struct bench_ctx *ctx = t->ctx;
+	static __thread char objs[BENCH_MAX_BURST * BENCH_MAX_ELEM];
+	unsigned int n;
+
+	pin(t->cpu);
+	pthread_barrier_wait(&ctx->start);
+	while (__atomic_load_n(&ctx->consumed, __ATOMIC_RELAXED) < ops) {
+		n = rte_ring_dequeue_burst(ctx->r, objs, ctx->burst, NULL);
+		if (n == 0) {
+			_mm_pause();
+			continue;
+		}
+		__atomic_fetch_add(&ctx->consumed, n, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+static void
+print_sep(void)
+{
+	if (!first_result)
+		printf(",\n");
+	first_result = 0;
+}
+
+/* Move ops objects through a ring with nthreads producers and consumers. */
+static void
+bench_throughput(unsigned int nthreads, unsigned int burst,
+	unsigned int elemlen, unsigned int slot_seq)
+{
+	const int len = (int)(slot_seq ?
+		rte_ring_slot_seq_get_memsize(BENCH_RING_SLOTS, elemlen) :
+		rte_ring_get_memsize(BENCH_RING_SLOTS, elemlen));
+	const unsigned int flags = nthreads == 1 ?
+		RING_F_POW2_SZ | RING_F_SP_ENQ | RING_F_SC_DEQ :
+		RING_F_POW2_SZ | (slot_seq ? RING_F_SLOT_SEQ : 0);
+	struct bench_thread t[2 * nthreads];
+	struct bench_ctx ctx;
+	uint64_t start, end;
+	unsigned int i;
+	void *p;
+
+	if (posix_memalign(&p, RTE_RING_INDEX_PAD, len) != 0)
+		return;
+	ctx.r = rte_ring_create(p, len, (int)elemlen, flags);
+	if (ctx.r == NULL) {
+		/* e.g. a sync mode the build options do not support */
+		fprintf(stderr, "ring_bench: cannot create the %s ring, "
+			"threads %u burst %u elem_size %u skipped\n",
+			nthreads == 1 ? "spsc" : slot_seq ? "mpmc_slot_seq" : "mpmc",
+			nthreads, burst, elemlen);
+		free(p);
+		return;
+	}
+	ctx.burst = burst;
+	ctx.consumed = 0;
+	pthread_barrier_init(&ctx.start, NULL, 2 * nthreads + 1);
+
+	for (i = 0; i < 2 * nthreads; i++) {
+		t[i].ctx = &ctx;
+		t[i].cpu = i;
+		t[i].count = ops / nthreads + (i < ops % nthreads);
+		pthread_create(&t[i].tid, NULL, i < nthreads ? producer : consumer,
+			&t[i]);
+	}
+	pthread_barrier_wait(&ctx.start);
+	start = now_ns();
+	for (i = 0; i < 2 * nthreads; i++)
+		pthread_join(t[i].tid, NULL);
+	end = now_ns();
+
+	print_sep();
+	printf("    {\"mode\": \"%s\", \"producers\": %u, \"consumers\": %u, "
+		"\"burst\": %u, \"elem_size\": %u, \"ops\": %lu, "
+		"\"seconds\": %.6f, \"mops\": %.3f, \"ns_per_op\": %.3f}",
+		nthreads == 1 ? "spsc" : slot_seq ? "mpmc_slot_seq" : "mpmc",
+		nthreads, nthreads, burst,
+		elemlen, ops, (end - start) / 1e9, ops * 1e3 / (end - start),
+		(double)(end - start) / ops);
+	fflush(stdout);
+
+	pthread_barrier_destroy(&ctx.start);
+	rte_ring_free(ctx.r);
+	free(p);
+}
+
+/*
+ * Echo side of the round trip: send back every timestamp received on
+ * ping, until a zero arrives.
+ */
+static void
+echo(struct rte_ring *ping, struct rte_ring *pong)
+{
+	uint64_t ts;
+
+	for (;;) {
+		while (rte_ring_sc_dequeue(ping, &ts) == 0)
+			_mm_pause();
+		while (rte_ring_sp_enqueue(pong, &ts) == 0)
+			_mm_pause();
+		if (ts == 0)
+			return;
+	}
+}
+
+struct echo_arg {
+	struct rte_ring *ping, *pong;
+};
+
+static void *
+echo_thread(void *arg)
+{
+	struct echo_arg *a = (struct echo_arg *)arg;
+
+	pin(1);
+	echo(a->ping, a->pong);
+	return NULL;
+}
+
+static int
+cmp_u64(const void *a, const void *b)
+{
+	const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* Send lat_samples timestamps around, and report the round-trip times. */
+static void
+measure_rtt(const char *mode, struct rte_ring *ping, struct rte_ring *pong)
+{
+	uint64_t *rtt = (uint64_t *)malloc(lat_samples * sizeof(*rtt));
+	uint64_t ts, zero = 0;
+	unsigned int i;
+
+	for (i = 0; i < lat_samples; i++) {
+		ts = now_ns();
+		while (rte_ring_sp_enqueue(ping, &ts) == 0)
+			_mm_pause();
+		while (rte_ring_sc_dequeue(pong, &ts) == 0)
+			_mm_pause();
+		rtt[i] = now_ns() - ts;
+	}
+	while (rte_ring_sp_enqueue(ping, &zero) == 0)
+		_mm_pause();
+	while (rte_ring_sc_dequeue(pong, &ts) == 0)
+		_mm_pause();
+
+	qsort(rtt, lat_samples, sizeof(*rtt), cmp_u64);
+	print_sep();
+	printf("    {\"mode\": \"%s\", \"samples\": %u, \"p50_ns\": %" PRIu64
+		", \"p99_ns\": %" PRIu64 ", \"p999_ns\": %" PRIu64
+		", \"max_ns\": %" PRIu64 "}",
+		mode, lat_samples, rtt[lat_samples / 2],
+		rtt[(uint64_t)lat_samples * 99 / 100],
+		rtt[(uint64_t)lat_samples * 999 / 1000], rtt[lat_samples - 1]);
+	fflush(stdout);
+	free(rtt);
+}
+
+static void
+bench_latency(int processes)
+{
+	const int len = (int)rte_ring_get_memsize(BENCH_RING_SLOTS,
+		sizeof(uint64_t));
+	const unsigned int flags = RING_F_POW2_SZ | RING_F_SP_ENQ |
+		RING_F_SC_DEQ;
+	struct rte_ring *ping, *pong;
+	struct echo_arg a;
+	pthread_t tid;
+	char *p;
+	pid_t pid;
+
+	p = (char *)mmap(NULL, 2 * len, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		return;
+	ping = rte_ring_create(p, len, sizeof(uint64_t), flags);
+	pong = rte_ring_create(p + len, len, sizeof(uint64_t), flags);
+	if (ping == NULL || pong == NULL) {
+		fprintf(stderr, "ring_bench: cannot create the %s latency rings, "
+			"skipped\n", processes ? "process" : "thread");
+		rte_ring_free(ping);
+		rte_ring_free(pong);
+		munmap(p, 2 * len);
+		return;
+	}
+
+	pin(0);
+	if (processes) {
+		pid = fork();
+		if (pid == 0) {
+			/* the child maps the rings like an unrelated process */
+			rte_ring_free(ping);
+			rte_ring_free(pong);
+			ping = rte_ring_attach(p);
+			pong = rte_ring_attach(p + len);
+			pin(1);
+			echo(ping, pong);
+			_exit(0);
+		}
+		measure_rtt("process", ping, pong);
+		waitpid(pid, NULL, 0);
+	} else {
+		a.ping = ping;
+		a.pong = pong;
+		pthread_create(&tid, NULL, echo_thread, &a);
+		measure_rtt("thread", ping, pong);
+		pthread_join(tid, NULL);
+	}
+
+	rte_ring_free(ping);
+	rte_ring_free(pong);
+	munmap(p, 2 * len);
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned int b, e, nthreads;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:t:l:L:")) != -1) {
+		switch (opt) {
+		case 'n':
+			ops = strtoul(optarg, NULL, 0);
+			break;
+		case 't':
+			max_threads = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			lat_samples = strtoul(optarg, NULL, 0);
+			break;
+		case 'L':
+			label = optarg;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n ops] [-t max_threads] "
+				"[-l latency_samples] [-L label]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (ops == 0 || max_threads == 0 || lat_samples == 0) {
+		fprintf(stderr, "%s: counts must be positive\n", argv[0]);
+		return 1;
+	}
+	/* the label is printed as is in the JSON */
+	if (label[strspn(label, "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+			"abcdefghijklmnopqrstuvwxyz0123456789._-")] != '\0') {
+		fprintf(stderr, "%s: label must be made of [A-Za-z0-9._-]\n",
+			argv[0]);
+		return 1;
+	}
+	ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+	printf("{\n  \"benchmark\": \"rte_ring\",\n  \"label\": \"%s\",\n"
+		"  \"cpus\": %d,\n  \"index_pad\": %d,\n  \"throughput\": [\n",
+		label, ncpu, RTE_RING_INDEX_PAD);
+	for (nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+		for (b = 0; b < sizeof(bursts) / sizeof(bursts[0]); b++)
+			for (e = 0; e < sizeof(elem_sizes) / sizeof(elem_sizes[0]); e++) {
+				bench_throughput(nthreads, bursts[b], elem_sizes[e], 0);
+				if (nthreads > 1)
+					bench_throughput(nthreads, bursts[b], elem_sizes[e], 1);
+			}
+
+	printf("\n  ],\n  \"latency\": [\n");
+	first_result = 1;
+	bench_latency(0);
+	bench_latency(1);
+	printf("\n  ]\n}\n");
+	return 0;
+}
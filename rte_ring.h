@@ -26,9 +26,10 @@
 * - Bulk dequeue.
 * - Bulk enqueue.
 *
-* Note: the ring implementation is not preemptible. Refer to Programmer's
-* guide/Environment Abstraction Layer/Multiple pthread/Known Issues/rte_ring
-* for more information.
+* Note: in the default multi-producer/consumer mode the ring is not
+* preemptible: a thread preempted between its head and tail updates stalls
+* the others of its side. Rings shared by more threads than CPUs should be
+* created with the RTS or HTS flags (RING_F_MP_RTS_ENQ, ...) instead.
 *
 */
 
@@ -38,26 +39,392 @@ extern "C" {
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <limits.h>
+#include <unistd.h>
 #include <emmintrin.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include <sys/queue.h>
 #include <sys/types.h>
 #include <sys/cdefs.h>
+#include <time.h>
+#ifdef RTE_RING_RECOVERY
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#endif
+
+#include "rte_ring_copy.h"
+#include "rte_ring_trace.h"
 
 #define RTE_CACHE_LINE_SIZE 64
 #define __rte_cache_aligned __attribute__((__aligned__(RTE_CACHE_LINE_SIZE)))
 #define __rte_always_inline inline __attribute__((always_inline))
 #define __rte_noinline  __attribute__((noinline))
+#ifndef offsetof
 #define offsetof(t, m) ((size_t) &((t *)0)->m)
+#endif
 #define likely(cond)  __glibc_likely(cond)
 #define unlikely(cond)  __glibc_unlikely(cond)
 
+/**
+ * Spacing of the head/tail indexes in the shared memory. Build with
+ * -DRTE_RING_INDEX_PAD=128 on CPUs whose adjacent-line prefetcher pulls
+ * cache lines in pairs, so that producer and consumer lines never share a
+ * 128-byte block. All processes using a ring must agree on it.
+ */
+#ifndef RTE_RING_INDEX_PAD
+#define RTE_RING_INDEX_PAD RTE_CACHE_LINE_SIZE
+#endif
+/** Offset of the statistics shards, after the indexes and the header. */
+#define RTE_RING_STATS_OFFSET (8 * RTE_RING_INDEX_PAD)
+/** Offset of the owner table of RTE_RING_RECOVERY, after the shards. */
+#define RTE_RING_OWNERS_OFFSET (RTE_RING_STATS_OFFSET + \
+	RTE_RING_STATS_SHARDS * sizeof(struct rte_ring_stats_shard))
+/** Offset of the latency stamps and histogram of RTE_RING_LATENCY. */
+#define RTE_RING_LAT_OFFSET (RTE_RING_OWNERS_OFFSET + \
+	RTE_RING_OWNERS * sizeof(struct rte_ring_owner))
+/** Shared memory reserved in front of the ring data. */
+#define RTE_RING_HDR_SIZE (RTE_RING_LAT_OFFSET + \
+	(RTE_RING_LAT_STAMPS == 0 ? 0 : sizeof(struct rte_ring_lat)))
+/** Offset of a waiter count within the cache line of each tail. */
+#define RTE_RING_WAITERS_OFFSET 32
+/** Offset of struct rte_ring_shm_hdr, after the four index cache lines. */
+#define RTE_RING_SHM_HDR_OFFSET (4 * RTE_RING_INDEX_PAD)
+#define RTE_RING_SHM_MAGIC 0x52544552 /**< "RTER" */
+#define RTE_RING_SHM_VERSION 1
+
+	/*
+	 * Head/tail index words. Build with -DRTE_RING_INDEX_64 to make them
+	 * 64-bit, moved with native 64-bit CAS, so that free-running counters
+	 * cannot come back to a value a stalled thread is about to CAS against
+	 * (ABA) in the lifetime of the ring. The layout is checked by
+	 * rte_ring_attach(), so all processes must be built the same way.
+	 * Relaxed tail sync needs the counter half of a 64-bit word and is not
+	 * available with 64-bit indexes.
+	 */
+#ifdef RTE_RING_INDEX_64
+	typedef uint64_t rte_ring_idx_t;
+#define RTE_RING_PRIidx PRIu64
+#else
+	typedef uint32_t rte_ring_idx_t;
+#define RTE_RING_PRIidx PRIu32
+#endif
+
 	enum rte_ring_queue_behavior {
 		RTE_RING_QUEUE_FIXED = 0, /* Enq/Deq a fixed number of items from a ring */
 		RTE_RING_QUEUE_VARIABLE   /* Enq/Deq as many items as possible from ring */
 	};
 
+	/** prod/cons sync types */
+	enum rte_ring_sync_type {
+		RTE_RING_SYNC_MT,     /**< multi-thread safe (default mode) */
+		RTE_RING_SYNC_ST,     /**< single thread only */
+		RTE_RING_SYNC_MT_RTS, /**< multi-thread relaxed tail sync */
+		RTE_RING_SYNC_MT_HTS, /**< multi-thread head/tail sync */
+	};
+
+#define RING_F_SP_ENQ 0x0001 /**< The default enqueue is "single-producer". */
+#define RING_F_SC_DEQ 0x0002 /**< The default dequeue is "single-consumer". */
+/**
+ * Round the ring size down to a power of two and run free-running head/tail
+ * counters that are masked with r->mask, instead of wrapping them modulo
+ * the size on every update.
+ */
+#define RING_F_POW2_SZ 0x0004
+/**
+ * Copy elements into the ring with non-temporal (streaming) stores, so the
+ * producer's cache is not filled with data read on another socket. Only
+ * used for elements of at least RTE_RING_COPY_MIN_SIMD bytes.
+ */
+#define RING_F_NT_ENQ 0x0008
+/**
+ * Let consumers and producers sleep in rte_ring_dequeue_wait() /
+ * rte_ring_enqueue_wait() (see rte_ring_wait.h). Every enqueue and dequeue
+ * then checks the other side's waiter count after publishing its tail.
+ */
+#define RING_F_WAIT 0x0010
+/**
+ * Relaxed tail sync: any number of producers (consumers) can be between
+ * head and tail, and no thread ever waits for another one. The last thread
+ * to finish moves the tail for all of them.
+ */
+#define RING_F_MP_RTS_ENQ 0x0020
+#define RING_F_MC_RTS_DEQ 0x0040 /**< Relaxed tail sync for dequeue. */
+/**
+ * Head/tail sync: a single producer (consumer) at a time is between head
+ * and tail, so it never waits in the tail update, and the zero-copy API of
+ * rte_ring_peek_zc.h can be used by several threads.
+ */
+#define RING_F_MP_HTS_ENQ 0x0400
+#define RING_F_MC_HTS_DEQ 0x0800 /**< Head/tail sync for dequeue. */
+/** Variable-length message ring, see rte_ring_msg.h. */
+#define RING_F_MSG 0x0080
+/** Every object goes to all readers, see rte_ring_bcast.h. */
+#define RING_F_BCAST 0x1000
+/** A full ring overwrites its oldest objects, see rte_ring_lossy.h. */
+#define RING_F_LOSSY 0x2000
+/**
+ * Slot sequence engine: every slot carries a sequence number that tells
+ * whether it is free or full for a given index, as in D. Vyukov's bounded
+ * MPMC queue. Producers and consumers only CAS the head and then publish
+ * their own slots, so none of them ever waits for another one in a tail
+ * update. The same enqueue/dequeue functions are used; the tails, the
+ * zero-copy API and RING_F_WAIT are not.
+ */
+#define RING_F_SLOT_SEQ 0x4000
+
+#ifndef RTE_RING_BACKOFF_MAX
+#define RTE_RING_BACKOFF_MAX 256 /**< Most pauses between two CAS retries */
+#endif
+
+	/**
+	 * Header describing the ring in the shared memory itself, so that another
+	 * process can map it with rte_ring_attach() without knowing the element
+	 * size or wiping the buffer. init_done is written last by
+	 * rte_ring_create().
+	 */
+	struct rte_ring_shm_hdr {
+		uint32_t magic;          /**< RTE_RING_SHM_MAGIC */
+		uint32_t version;        /**< RTE_RING_SHM_VERSION */
+		uint32_t size;           /**< Size of ring. */
+		uint32_t elemlen;        /**< Size of the element */
+		uint32_t flags;          /**< Flags supplied at creation. */
+		uint32_t init_done;      /**< Non-zero once the ring is usable */
+		uint32_t index_pad;      /**< RTE_RING_INDEX_PAD of the creator */
+		uint32_t stats_shards;   /**< RTE_RING_STATS_SHARDS of the creator */
+		uint32_t readers;        /**< Broadcast readers, after the data */
+		uint32_t index_size;     /**< sizeof(rte_ring_idx_t) of the creator */
+		uint32_t owners;         /**< RTE_RING_OWNERS of the creator */
+		uint32_t lat_stamps;     /**< RTE_RING_LAT_STAMPS of the creator */
+		uint32_t lat_sample;     /**< RTE_RING_LAT_SAMPLE of the creator */
+		/** Producer moves in flight with no owner entry (RTE_RING_RECOVERY) */
+		uint32_t prod_untracked;
+		/** Consumer moves in flight with no owner entry (RTE_RING_RECOVERY) */
+		uint32_t cons_untracked;
+	};
+
+	/**
+	 * Position of one reader of a broadcast ring. The cursors follow the
+	 * ring data, one per line.
+	 */
+	struct rte_ring_bcast_cursor {
+		rte_ring_idx_t pos;      /**< Next index the reader will read */
+		uint32_t active;         /**< Zero once the reader has left */
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+/**
+ * Bytes of ring data, rounded to a line, before the per-reader cursors of
+ * a broadcast ring or the slot sequence numbers of a lossy or
+ * RING_F_SLOT_SEQ ring.
+ */
+#define RTE_RING_DATA_SIZE(count, elemlen) \
+	(((size_t)(count) * (elemlen) + RTE_RING_INDEX_PAD - 1) & \
+		~(size_t)(RTE_RING_INDEX_PAD - 1))
+
+	/*
+	 * Statistics. Build with -DRTE_RING_STATS to keep counters in the shared
+	 * memory, between the header and the data, where a monitoring process
+	 * can read them with rte_ring_get_stats() after rte_ring_attach(). It
+	 * must be built with the same settings, which rte_ring_attach() checks.
+	 * By default the counters compile to nothing and take no memory.
+	 *
+	 * Counters are sharded by thread id, and the producer and consumer
+	 * halves of a shard are on separate lines, so counting does not add
+	 * sharing between threads or between the two sides.
+	 */
+#ifdef RTE_RING_STATS
+#ifndef RTE_RING_STATS_SHARDS
+#define RTE_RING_STATS_SHARDS 16 /**< Counter shards per ring */
+#endif
+#ifndef RTE_RING_OCC_SAMPLE
+#define RTE_RING_OCC_SAMPLE 64   /**< Enqueues per histogram sample, pow2 */
+#endif
+#else
+#undef RTE_RING_STATS_SHARDS
+#define RTE_RING_STATS_SHARDS 0
+#endif
+/** Occupancy histogram buckets: 0, then [2^(b-1), 2^b) for bucket b. */
+#define RTE_RING_OCC_BUCKETS 33
+
+	/** Counters updated by producers, in one shard. */
+	struct rte_ring_stats_prod {
+		uint64_t enq_calls;      /**< Enqueues that moved objects */
+		uint64_t enq_objs;       /**< Objects enqueued */
+		uint64_t enq_fail;       /**< Enqueues that found the ring full */
+		uint64_t cas_retry;      /**< Failed producer head CAS */
+		uint64_t tail_spin;      /**< Pauses waiting for other producers */
+		uint64_t hwm;            /**< Most entries seen after an enqueue */
+		/** Sampled entries after an enqueue, log2 buckets */
+		uint64_t occ_hist[RTE_RING_OCC_BUCKETS];
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	/** Counters updated by consumers, in one shard. */
+	struct rte_ring_stats_cons {
+		uint64_t deq_calls;      /**< Dequeues that moved objects */
+		uint64_t deq_objs;       /**< Objects dequeued */
+		uint64_t deq_fail;       /**< Dequeues that found the ring empty */
+		uint64_t cas_retry;      /**< Failed consumer head CAS */
+		uint64_t tail_spin;      /**< Pauses waiting for other consumers */
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	struct rte_ring_stats_shard {
+		struct rte_ring_stats_prod prod;
+		struct rte_ring_stats_cons cons;
+	};
+
+#ifdef RTE_RING_STATS
+	static __thread int __rte_ring_stats_slot = -1;
+
+	/** @internal Shard of the calling thread. */
+	static __rte_always_inline unsigned int
+		__rte_ring_stats_id(void)
+	{
+		if (unlikely(__rte_ring_stats_slot < 0))
+			__rte_ring_stats_slot =
+				(int)(syscall(SYS_gettid) % RTE_RING_STATS_SHARDS);
+		return (unsigned int)__rte_ring_stats_slot;
+	}
+
+#define RTE_RING_STAT_ADD(r, side, field, v) \
+	__atomic_fetch_add(&(r)->stats[__rte_ring_stats_id()].side.field, \
+		(v), __ATOMIC_RELAXED)
+
+	static __thread uint32_t __rte_ring_occ_tick;
+
+	/**
+	 * @internal Record the ring depth after an enqueue: always in the
+	 * high-water mark, every RTE_RING_OCC_SAMPLE calls in the histogram.
+	 */
+	static __rte_always_inline void
+		__rte_ring_stats_occ(struct rte_ring_stats_prod *s, uint32_t depth)
+	{
+		uint64_t hwm = __atomic_load_n(&s->hwm, __ATOMIC_RELAXED);
+
+		while (unlikely(depth > hwm) &&
+			!__atomic_compare_exchange_n(&s->hwm, &hwm, depth, 0,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			;
+		if (unlikely((++__rte_ring_occ_tick & (RTE_RING_OCC_SAMPLE - 1)) == 0))
+			__atomic_fetch_add(&s->occ_hist[depth == 0 ? 0 :
+				32 - __builtin_clz(depth)], 1, __ATOMIC_RELAXED);
+	}
+
+#define RTE_RING_STAT_OCC(r, depth) \
+	__rte_ring_stats_occ(&(r)->stats[__rte_ring_stats_id()].prod, (depth))
+#else
+#define RTE_RING_STAT_ADD(r, side, field, v) do { } while (0)
+#define RTE_RING_STAT_OCC(r, depth) do { } while (0)
+#endif
+
+	/*
+	 * Crash recovery. Build with -DRTE_RING_RECOVERY to record, in a table
+	 * after the statistics, the head move each thread has in flight on
+	 * either side, with its pid. When a process dies between a head move
+	 * and its tail update, the others of that side wait for the tail
+	 * forever; rte_ring_recover() finds moves whose owner is dead and
+	 * finishes them. The table size is checked by rte_ring_attach().
+	 * Without the flag nothing is recorded and the layout is unchanged.
+	 */
+#ifdef RTE_RING_RECOVERY
+#ifndef RTE_RING_OWNERS
+#define RTE_RING_OWNERS 64       /**< Threads tracked per ring */
+#endif
+#else
+#undef RTE_RING_OWNERS
+#define RTE_RING_OWNERS 0
+#endif
+
+	/** Head move of one thread on one side, from old_head to new_head. */
+	struct rte_ring_resv {
+		rte_ring_idx_t old_head; /**< Head the move starts at */
+		rte_ring_idx_t new_head; /**< Head the move ends at */
+		uint32_t active;         /**< Set from before the head CAS to after
+		                              the tail update */
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	/** Entry of the owner table, claimed by one thread. */
+	struct rte_ring_owner {
+		uint32_t tid;            /**< Thread that claimed it, 0 if free */
+		uint32_t pid;            /**< Its process */
+		struct rte_ring_resv prod;
+		struct rte_ring_resv cons;
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	/*
+	 * Queueing latency. Build with -DRTE_RING_LATENCY to stamp one object
+	 * index in RTE_RING_LAT_SAMPLE with the TSC when it is enqueued, and to
+	 * add the TSC delta to a histogram when it is dequeued. Which indexes
+	 * are sampled depends only on the index, so both sides agree without
+	 * talking. The stamps are a table of RTE_RING_LAT_STAMPS words indexed
+	 * by sampled index, after the owner table; each word holds 48 bits of
+	 * TSC and a tag of the index, so a stamp overwritten by a later lap is
+	 * skipped. The histogram is HDR style: RTE_RING_LAT_SUB linear buckets
+	 * per power of two of cycles. Read it with rte_ring_get_latency() from
+	 * any process built with the same settings. Without the flag no stamp
+	 * is taken and the layout is unchanged.
+	 */
+#ifdef RTE_RING_LATENCY
+#ifndef RTE_RING_LAT_SAMPLE
+#define RTE_RING_LAT_SAMPLE 64   /**< Indexes per stamped one, pow2 */
+#endif
+#ifndef RTE_RING_LAT_STAMPS
+#define RTE_RING_LAT_STAMPS 1024 /**< Stamp words per ring, pow2 */
+#endif
+#else
+#undef RTE_RING_LAT_SAMPLE
+#undef RTE_RING_LAT_STAMPS
+#define RTE_RING_LAT_SAMPLE 1
+#define RTE_RING_LAT_STAMPS 0
+#endif
+#define RTE_RING_LAT_SUB_BITS 4
+#define RTE_RING_LAT_SUB (1 << RTE_RING_LAT_SUB_BITS) /**< Buckets per 2^n */
+#define RTE_RING_LAT_TSC_BITS 48 /**< TSC bits kept in a stamp */
+/** Histogram buckets: values below RTE_RING_LAT_SUB, then SUB per 2^n. */
+#define RTE_RING_LAT_BUCKETS \
+	((RTE_RING_LAT_TSC_BITS - RTE_RING_LAT_SUB_BITS + 1) * RTE_RING_LAT_SUB)
+
+	/** Latency histogram of a ring, in TSC cycles. */
+	struct rte_ring_lat_hist {
+		uint64_t count;          /**< Samples */
+		uint64_t sum;            /**< Sum of the samples */
+		uint64_t max;            /**< Largest sample */
+		uint64_t buckets[RTE_RING_LAT_BUCKETS];
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	/** Stamps written by producers and histogram fed by consumers. */
+	struct rte_ring_lat {
+		uint64_t stamps[RTE_RING_LAT_STAMPS ? RTE_RING_LAT_STAMPS : 1]
+			__attribute__((aligned(RTE_RING_INDEX_PAD)));
+		struct rte_ring_lat_hist hist;
+	};
+
+	/**
+	 * Copy of the other side's tail kept by a single producer or consumer,
+	 * valid while its own head is still the one it last stored.
+	 */
+	struct rte_ring_shadow {
+		rte_ring_idx_t head;     /**< Own head when tail was copied */
+		rte_ring_idx_t tail;     /**< Copy of the other side's tail */
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	/**
+	 * Head or tail of an RTS side: the 32-bit index the other side reads,
+	 * followed by the number of updates. pos comes first so that on this
+	 * little-endian layout *r->prod_tail etc. still read the index.
+	 */
+	union __rte_ring_rts_poscnt {
+		uint64_t raw;
+		struct {
+			uint32_t pos;    /**< head/tail index */
+			uint32_t cnt;    /**< head/tail update count */
+		} val;
+	};
+
 	/**
 	 * An RTE ring structure.
 	 *
@@ -67,6 +434,7 @@ extern "C" {
 	 * field. Thanks to this assumption, we can do subtractions between 2 index
 	 * values in a modulo-32bit base: that's why the overflow of the indexes is not
 	 * a problem.
+	 * With RTE_RING_INDEX_64 the same holds modulo 2^64.
 	 */
 	struct rte_ring {
 		/*
@@ -78,29 +446,445 @@ extern "C" {
 		uint32_t mask;           /**< Mask (size-1) of ring. */
 		uint32_t capacity;       /**< Usable size of ring */
 		uint32_t elemlen;
+		uint32_t flags;          /**< Flags supplied at creation. */
+		enum rte_ring_sync_type prod_sync_type; /**< Producer sync mode */
+		enum rte_ring_sync_type cons_sync_type; /**< Consumer sync mode */
 
 		/** Ring producer status. */
-		volatile uint32_t* prod_head;
-		volatile uint32_t* prod_tail;
-		volatile uint32_t* cons_head;
-		volatile uint32_t* cons_tail;
+		volatile rte_ring_idx_t* prod_head;
+		volatile rte_ring_idx_t* prod_tail;
+		volatile rte_ring_idx_t* cons_head;
+		volatile rte_ring_idx_t* cons_tail;
+		volatile uint32_t* prod_waiters; /**< Threads sleeping on prod_tail */
+		volatile uint32_t* cons_waiters; /**< Threads sleeping on cons_tail */
 
 		void* data;
-	}__rte_cache_aligned;
+		struct rte_ring_shm_hdr* hdr; /**< Header in the shared memory */
+		rte_ring_copy_t enq_copy; /**< Copy routine into the ring */
+		rte_ring_copy_t deq_copy; /**< Copy routine out of the ring */
+		size_t map_len;          /**< Length of a mapping owned by the ring */
+		struct rte_ring_stats_shard* stats; /**< NULL without RTE_RING_STATS */
+		struct rte_ring_bcast_cursor* bcast; /**< Readers of RING_F_BCAST */
+		volatile rte_ring_idx_t* seq; /**< Slot sequences, LOSSY or SLOT_SEQ */
+		struct rte_ring_owner* owners; /**< NULL without RTE_RING_RECOVERY */
+		struct rte_ring_lat* lat; /**< NULL without RTE_RING_LATENCY */
+		volatile uint64_t* ready_word; /**< Ring set bitmap word, or NULL */
+		uint64_t ready_bit;      /**< Bit of this ring in *ready_word */
+
+		/*
+		 * Single producer/consumer copies of the other side's tail, each on
+		 * its own line. The opposite tail only moves forward, so a stale
+		 * copy can only underestimate the room or the entries; the shared
+		 * line is read again only when the copy says full or empty, or when
+		 * the head was moved by someone else (e.g. another process).
+		 */
+		struct rte_ring_shadow prod_shadow; /**< cons_tail seen by producer */
+		struct rte_ring_shadow cons_shadow; /**< prod_tail seen by consumer */
+	}__attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	/**
+	 * @internal Normalize a head/tail value after it has been advanced.
+	 * Free-running counters of a power-of-two ring are left to wrap at 2^32.
+	 */
+	static __rte_always_inline rte_ring_idx_t
+		__rte_ring_wrap(const struct rte_ring *r, rte_ring_idx_t idx)
+	{
+		if (likely(r->flags & RING_F_POW2_SZ))
+			return idx;
+		return idx % r->size;
+	}
+
+	/**
+	 * @internal Number of entries between two head/tail values (a - b).
+	 */
+	static __rte_always_inline uint32_t
+		__rte_ring_distance(const struct rte_ring *r, rte_ring_idx_t a,
+			rte_ring_idx_t b)
+	{
+		if (likely(r->flags & RING_F_POW2_SZ))
+			return (uint32_t)(a - b);
+		return (uint32_t)((a - b + r->size) % r->size);
+	}
+
+	/**
+	 * @internal Slot index in r->data of a head/tail value.
+	 */
+	static __rte_always_inline uint32_t
+		__rte_ring_slot(const struct rte_ring *r, rte_ring_idx_t idx)
+	{
+		if (likely(r->flags & RING_F_POW2_SZ))
+			return (uint32_t)(idx & r->mask);
+		return (uint32_t)(idx % r->size);
+	}
+
+#ifdef RTE_RING_RECOVERY
+	static __thread uint32_t __rte_ring_owner_tid;
+	static __thread uint32_t __rte_ring_owner_pid;
+
+	/** @internal A forked child is a new thread, with its own entries. */
+	static void
+		__rte_ring_owner_atfork(void)
+	{
+		__rte_ring_owner_tid = 0;
+	}
+
+	static void
+		__rte_ring_owner_once(void)
+	{
+		pthread_atfork(NULL, NULL, __rte_ring_owner_atfork);
+	}
+
+	/**
+	 * @internal Non-zero unless process pid is gone or a zombie. A pid
+	 * of 0 is an entry being claimed, taken as alive.
+	 */
+	static inline int
+		__rte_ring_pid_alive(uint32_t pid)
+	{
+		char path[32], buf[256], *s;
+		ssize_t len;
+		int fd;
+
+		if (pid == 0)
+			return 1;
+		if (kill((pid_t)pid, 0) < 0 && errno != EPERM)
+			return 0;
+		/* kill() succeeds on a child that was not reaped yet */
+		snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+		fd = open(path, O_RDONLY);
+		if (fd < 0)
+			return 1;
+		len = read(fd, buf, sizeof(buf) - 1);
+		close(fd);
+		if (len <= 0)
+			return 1;
+		buf[len] = '\0';
+		s = strrchr(buf, ')');
+		return s == NULL || (s[1] != ' ' || (s[2] != 'Z' && s[2] != 'X'));
+	}
+
+	/**
+	 * @internal Claim an entry of the owner table for the calling thread:
+	 * its own one, a free one, or one whose thread is gone with nothing in
+	 * flight. NULL if the table is full; the thread is then not tracked.
+	 */
+	static __rte_noinline struct rte_ring_owner *
+		__rte_ring_owner_claim(const struct rte_ring *r)
+	{
+		static pthread_once_t once = PTHREAD_ONCE_INIT;
+		struct rte_ring_owner *o;
+		uint32_t tid, i, pass;
+
+		if (__rte_ring_owner_tid == 0) {
+			pthread_once(&once, __rte_ring_owner_once);
+			__rte_ring_owner_tid = (uint32_t)syscall(SYS_gettid);
+			__rte_ring_owner_pid = (uint32_t)getpid();
+		}
+		for (pass = 0; pass < 2; pass++)
+			for (i = 0; i < RTE_RING_OWNERS; i++) {
+				o = &r->owners[(__rte_ring_owner_tid + i) % RTE_RING_OWNERS];
+				tid = __atomic_load_n(&o->tid, __ATOMIC_ACQUIRE);
+				if (tid == __rte_ring_owner_tid &&
+					o->pid == __rte_ring_owner_pid)
+					return o;
+				if (pass == 0 ? tid != 0 :
+					(o->prod.active || o->cons.active ||
+						syscall(SYS_tgkill, o->pid, tid, 0) == 0 ||
+						errno == EPERM))
+					continue;
+				if (__atomic_compare_exchange_n(&o->tid, &tid,
+						__rte_ring_owner_tid, 0, __ATOMIC_ACQUIRE,
+						__ATOMIC_RELAXED)) {
+					__atomic_store_n(&o->pid, __rte_ring_owner_pid,
+						__ATOMIC_RELEASE);
+					return o;
+				}
+			}
+		return NULL;
+	}
+
+	/** @internal Entry the calling thread already holds, anywhere. */
+	static __rte_noinline struct rte_ring_owner *
+		__rte_ring_owner_lookup(const struct rte_ring *r)
+	{
+		struct rte_ring_owner *o;
+		uint32_t i;
+
+		for (i = 0; i < RTE_RING_OWNERS; i++) {
+			o = &r->owners[i];
+			if (o->tid == __rte_ring_owner_tid &&
+				o->pid == __rte_ring_owner_pid)
+				return o;
+		}
+		return NULL;
+	}
+
+	/**
+	 * @internal Owner table entry of the calling thread, without claiming
+	 * one, or NULL.
+	 */
+	static __rte_always_inline struct rte_ring_owner *
+		__rte_ring_owner_find(const struct rte_ring *r)
+	{
+		struct rte_ring_owner *o =
+			&r->owners[__rte_ring_owner_tid % RTE_RING_OWNERS];
+
+		if (unlikely(__rte_ring_owner_tid == 0))
+			return NULL;
+		if (likely(o->tid == __rte_ring_owner_tid &&
+				o->pid == __rte_ring_owner_pid))
+			return o;
+		return __rte_ring_owner_lookup(r);
+	}
+
+	/** @internal Owner table entry of the calling thread, or NULL. */
+	static __rte_always_inline struct rte_ring_owner *
+		__rte_ring_owner(const struct rte_ring *r)
+	{
+		struct rte_ring_owner *o =
+			&r->owners[__rte_ring_owner_tid % RTE_RING_OWNERS];
 
+		if (likely(o->tid == __rte_ring_owner_tid && __rte_ring_owner_tid != 0 &&
+				o->pid == __rte_ring_owner_pid))
+			return o;
+		return __rte_ring_owner_claim(r);
+	}
+
+	/*
+	 * Record a head move before the head is written; the CAS orders it.
+	 * A thread without an entry counts its move as untracked instead, so
+	 * that rte_ring_recover() knows it cannot tell who owns what.
+	 */
+#define RTE_RING_RESV_BEGIN(r, side, old, new) do { \
+		struct rte_ring_owner *__o = __rte_ring_owner(r); \
+		if (likely(__o != NULL)) { \
+			__o->side.old_head = (old); \
+			__o->side.new_head = (new); \
+			__atomic_store_n(&__o->side.active, 1, __ATOMIC_RELEASE); \
+		} else \
+			__atomic_fetch_add(&(r)->hdr->side##_untracked, 1, \
+				__ATOMIC_SEQ_CST); \
+	} while (0)
+	/* End the move of an MT or ST side started by RTE_RING_RESV_BEGIN(). */
+#define RTE_RING_RESV_END(r, side, sync) do { \
+		struct rte_ring_owner *__o; \
+		if ((sync) > RTE_RING_SYNC_ST) \
+			break; \
+		__o = __rte_ring_owner_find(r); \
+		if (likely(__o != NULL && __o->side.active)) \
+			__atomic_store_n(&__o->side.active, 0, __ATOMIC_RELEASE); \
+		else \
+			__atomic_fetch_sub(&(r)->hdr->side##_untracked, 1, \
+				__ATOMIC_RELEASE); \
+	} while (0)
+#else
+#define RTE_RING_RESV_BEGIN(r, side, old, new) do { } while (0)
+#define RTE_RING_RESV_END(r, side, sync) do { } while (0)
+#endif
+
+	/** @internal Histogram bucket of a latency of v cycles. */
+	static __rte_always_inline unsigned int
+		__rte_ring_lat_bucket(uint64_t v)
+	{
+		unsigned int e;
+
+		if (v < RTE_RING_LAT_SUB)
+			return (unsigned int)v;
+		e = 63 - __builtin_clzll(v);
+		return (e - RTE_RING_LAT_SUB_BITS + 1) * RTE_RING_LAT_SUB +
+			(unsigned int)((v >> (e - RTE_RING_LAT_SUB_BITS)) &
+				(RTE_RING_LAT_SUB - 1));
+	}
+
+#ifdef RTE_RING_LATENCY
+	/**
+	 * @internal Stamp (deq == 0) or measure (deq != 0) the sampled indexes
+	 * among the n from start, which do not wrap.
+	 */
+	static __rte_always_inline void
+		__rte_ring_lat_seg(struct rte_ring *r, rte_ring_idx_t start,
+			uint32_t n, int deq)
+	{
+		const uint64_t mask = ((uint64_t)1 << RTE_RING_LAT_TSC_BITS) - 1;
+		struct rte_ring_lat_hist *h = &r->lat->hist;
+		rte_ring_idx_t k = start + ((-start) & (RTE_RING_LAT_SAMPLE - 1));
+		uint64_t now, w, tag, d, max;
+
+		if (likely((rte_ring_idx_t)(k - start) >= n))
+			return;
+		now = __rdtsc() & mask;
+		for (; (rte_ring_idx_t)(k - start) < n; k += RTE_RING_LAT_SAMPLE) {
+			const uint64_t s = k / RTE_RING_LAT_SAMPLE;
+			uint64_t *stamp = &r->lat->stamps[s & (RTE_RING_LAT_STAMPS - 1)];
+
+			tag = (s / RTE_RING_LAT_STAMPS) & 0xffff;
+			if (!deq) {
+				__atomic_store_n(stamp, now << 16 | tag, __ATOMIC_RELAXED);
+				continue;
+			}
+			w = __atomic_load_n(stamp, __ATOMIC_RELAXED);
+			if ((w & 0xffff) != tag)
+				continue;
+			d = (now - (w >> 16)) & mask;
+			__atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+			__atomic_fetch_add(&h->sum, d, __ATOMIC_RELAXED);
+			__atomic_fetch_add(&h->buckets[__rte_ring_lat_bucket(d)], 1,
+				__ATOMIC_RELAXED);
+			max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+			while (unlikely(d > max) &&
+				!__atomic_compare_exchange_n(&h->max, &max, d, 0,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				;
+		}
+	}
 
+	/** @internal Stamp or measure the indexes from head to next. */
 	static __rte_always_inline void
-		update_tail(uint32_t* head, uint32_t* tail, uint32_t old_val, uint32_t new_val)
+		__rte_ring_lat_range(struct rte_ring *r, rte_ring_idx_t head,
+			rte_ring_idx_t next, int deq)
+	{
+		const uint32_t n = __rte_ring_distance(r, next, head);
+
+		if (likely(r->flags & RING_F_POW2_SZ) || head + n <= r->size)
+			__rte_ring_lat_seg(r, head, n, deq);
+		else {
+			__rte_ring_lat_seg(r, head, r->size - head, deq);
+			__rte_ring_lat_seg(r, 0, n - (r->size - head), deq);
+		}
+	}
+
+	/* Stamps are written before the objects are published, read before the
+	 * slots are handed back. */
+#define RTE_RING_LAT_STAMP(r, head, next) __rte_ring_lat_range(r, head, next, 0)
+#define RTE_RING_LAT_RECORD(r, head, next) __rte_ring_lat_range(r, head, next, 1)
+#else
+#define RTE_RING_LAT_STAMP(r, head, next) do { } while (0)
+#define RTE_RING_LAT_RECORD(r, head, next) do { } while (0)
+#endif
+
+
+	/* Returns the number of pauses spent waiting for other threads. */
+	static __rte_always_inline unsigned int
+		update_tail(volatile rte_ring_idx_t* tail, rte_ring_idx_t old_val,
+			rte_ring_idx_t new_val, uint32_t single)
 	{
+		unsigned int spins = 0;
+
 		/*
 		* If there are other enqueues/dequeues in progress that preceded us,
 		* we need to wait for them to complete
 		*/
-		//if (!single)
-		while (unlikely(*tail != old_val))
-			_mm_pause();
+		if (!single)
+			while (unlikely(*tail != old_val)) {
+				_mm_pause();
+				spins++;
+			}
 
 		__atomic_store_n(tail, new_val, __ATOMIC_RELEASE);
+		return spins;
+	}
+
+	/** @internal Monotonic time in nanoseconds. */
+	static inline uint64_t
+		__rte_ring_now_ns(void)
+	{
+		struct timespec ts;
+
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	}
+
+	/**
+	* @internal Pause before retrying a failed CAS, twice as long as last
+	* time, so that contending threads spread out instead of all retrying
+	* on the same cache line.
+	*/
+	static __rte_always_inline void
+		__rte_ring_backoff(unsigned int *backoff)
+	{
+		unsigned int i;
+
+		for (i = 0; i < *backoff; i++)
+			_mm_pause();
+		if (*backoff < RTE_RING_BACKOFF_MAX)
+			*backoff <<= 1;
+	}
+
+	/**
+	* @internal Wake the threads sleeping on a tail that was just moved, if
+	* there are any. The fence orders the tail store before the waiters load;
+	* waiters do the opposite (see rte_ring_wait.h), so no wakeup is lost.
+	* The futex is the low 32 bits of the tail.
+	*/
+	static __rte_always_inline void
+		__rte_ring_wake(volatile rte_ring_idx_t* tail, volatile uint32_t* waiters)
+	{
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (unlikely(__atomic_load_n(waiters, __ATOMIC_RELAXED) != 0))
+			syscall(SYS_futex, tail, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+	}
+
+	/**
+	* @internal Mark the ring ready in the bitmap of the ring set it was
+	* added to (see rte_ring_set.h), after its tail was moved. The bit is
+	* only written when it is clear, so a busy ring only reads the line.
+	* The fence pairs with the one after the consumer clears the bit.
+	*/
+	static __rte_always_inline void
+		__rte_ring_notify(struct rte_ring *r)
+	{
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (!(__atomic_load_n(r->ready_word, __ATOMIC_RELAXED) & r->ready_bit))
+			__atomic_fetch_or(r->ready_word, r->ready_bit, __ATOMIC_RELAXED);
+	}
+
+	/**
+	* @internal __rte_ring_notify() at the end of an enqueue from prod_head.
+	* Only a producer that found the ring empty (cons_tail == prod_head)
+	* pays for the fence. One that reserved behind unconsumed objects
+	* skips it: the consumer either finds these objects along with the
+	* older ones, or drains the older ones and then sees the head move in
+	* rte_ring_set_dequeue_id(). That relies on the head CAS being a full
+	* barrier, so a single producer, which moves its head with a plain
+	* store, always notifies.
+	*/
+	static __rte_always_inline void
+		__rte_ring_notify_enq(struct rte_ring *r, rte_ring_idx_t prod_head,
+			unsigned int is_sp)
+	{
+		if (is_sp != RTE_RING_SYNC_ST &&
+			__atomic_load_n(r->cons_tail, __ATOMIC_RELAXED) != prod_head)
+			return;
+		__rte_ring_notify(r);
+	}
+
+	/**
+	* @internal Index up to which producers may write: the consumer tail,
+	* or for a broadcast ring the cursor of the slowest active reader. A
+	* broadcast ring without active readers, or a lossy ring, is all free
+	* space.
+	*/
+	static __rte_always_inline rte_ring_idx_t
+		__rte_ring_prod_limit(const struct rte_ring *r, rte_ring_idx_t prod_head)
+	{
+		rte_ring_idx_t limit = prod_head, pos;
+		uint32_t lag = 0, i;
+
+		if (likely(!(r->flags & (RING_F_BCAST | RING_F_LOSSY))))
+			return __atomic_load_n(r->cons_tail, __ATOMIC_ACQUIRE);
+		if (r->flags & RING_F_LOSSY)
+			return prod_head;
+
+		for (i = 0; i < r->hdr->readers; i++) {
+			if (!__atomic_load_n(&r->bcast[i].active, __ATOMIC_RELAXED))
+				continue;
+			pos = __atomic_load_n(&r->bcast[i].pos, __ATOMIC_ACQUIRE);
+			if (__rte_ring_distance(r, prod_head, pos) > lag) {
+				lag = __rte_ring_distance(r, prod_head, pos);
+				limit = pos;
+			}
+		}
+		return limit;
 	}
 
 	/**
@@ -127,16 +911,17 @@ extern "C" {
 	*   If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
 	*/
 	static __rte_always_inline unsigned int
-		__rte_ring_move_prod_head(struct rte_ring *r,
+		__rte_ring_move_prod_head(struct rte_ring *r, unsigned int is_sp,
 			unsigned int n, enum rte_ring_queue_behavior behavior,
-			uint32_t *old_head, uint32_t *new_head)
+			rte_ring_idx_t *old_head, rte_ring_idx_t *new_head,
+			uint32_t *free_entries)
 	{
 		//prod_head = old_head, prod_next=new_head
-		const uint32_t size = r->size;
 		const uint32_t capacity = r->capacity;
 		unsigned int max = n;
+		unsigned int backoff = 1;
 		int success;
-		int free_entries = 0;
+		rte_ring_idx_t cons_tail;
 
 		do {
 			/* Reset n to the initial burst count */
@@ -144,6 +929,11 @@ extern "C" {
 
 			*old_head = __atomic_load_n(r->prod_head,
 				__ATOMIC_ACQUIRE);
+			cons_tail = r->prod_shadow.tail;
+			if (!is_sp || unlikely(r->prod_shadow.head != *old_head) ||
+				unlikely(n > capacity -
+					__rte_ring_distance(r, *old_head, cons_tail)))
+				cons_tail = __rte_ring_prod_limit(r, *old_head);
 
 			/*
 			*  The subtraction is done between two unsigned 32bits value
@@ -152,25 +942,34 @@ extern "C" {
 			* and capacity (which is < size).
 			*/
 			//printf("free_entries:%d %d %d\n",free_entries,capacity + *r->cons_tail - *old_head,size);
-			free_entries = (capacity + *r->cons_tail - *old_head) % size;
+			*free_entries = capacity - __rte_ring_distance(r, *old_head, cons_tail);
 
 			/* check that we have enough room in ring */
-			if (unlikely(n > free_entries))
+			if (unlikely(n > *free_entries))
 				n = (behavior == RTE_RING_QUEUE_FIXED) ?
-				0 : free_entries;
+				0 : *free_entries;
 
 			if (n == 0)
 				return 0;
 
-			*new_head = (*old_head + n) % size;
-			//if (is_sp)
-			//	r->prod.head = *new_head, success = 1;
-			//else
-			//multiproduction cann't make sure success by one step
-			success = __atomic_compare_exchange_n(r->prod_head,
-				old_head, *new_head,
-				0, __ATOMIC_ACQUIRE,
-				__ATOMIC_RELAXED);
+			*new_head = __rte_ring_wrap(r, *old_head + n);
+			RTE_RING_RESV_BEGIN(r, prod, *old_head, *new_head);
+			if (is_sp) {
+				*r->prod_head = *new_head, success = 1;
+				r->prod_shadow.head = *new_head;
+				r->prod_shadow.tail = cons_tail;
+			} else {
+				//multiproduction cann't make sure success by one step
+				success = __atomic_compare_exchange_n(r->prod_head,
+					old_head, *new_head,
+					0, __ATOMIC_ACQUIRE,
+					__ATOMIC_RELAXED);
+				if (unlikely(success == 0)) {
+					RTE_RING_RESV_END(r, prod, RTE_RING_SYNC_MT);
+					RTE_RING_STAT_ADD(r, prod, cas_retry, 1);
+					__rte_ring_backoff(&backoff);
+				}
+			}
 		} while (unlikely(success == 0));
 		return n;
 	}
@@ -199,15 +998,15 @@ extern "C" {
 	*     If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
 	*/
 	static __rte_always_inline unsigned int
-		__rte_ring_move_cons_head(struct rte_ring *r,
+		__rte_ring_move_cons_head(struct rte_ring *r, unsigned int is_sc,
 			unsigned int n, enum rte_ring_queue_behavior behavior,
-			uint32_t *old_head, uint32_t *new_head,
+			rte_ring_idx_t *old_head, rte_ring_idx_t *new_head,
 			uint32_t *entries)
 	{
-		const uint32_t size = r->size;
-		const uint32_t capacity = r->capacity;
 		unsigned int max = n;
+		unsigned int backoff = 1;
 		int success;
+		rte_ring_idx_t prod_tail;
 
 		/* move cons.head atomically */
 		do {
@@ -215,13 +1014,18 @@ extern "C" {
 			n = max;
 			*old_head = __atomic_load_n(r->cons_head,
 				__ATOMIC_ACQUIRE);
+			prod_tail = r->cons_shadow.tail;
+			if (!is_sc || unlikely(r->cons_shadow.head != *old_head) ||
+				unlikely(n > __rte_ring_distance(r, prod_tail, *old_head)))
+				prod_tail = __atomic_load_n(r->prod_tail,
+					__ATOMIC_ACQUIRE);
 
 			/* The subtraction is done between two unsigned 32bits value
 			* (the result is always modulo 32 bits even if we have
 			* cons_head > prod_tail). So 'entries' is always between 0
 			* and size(ring)-1.
 			*/
-			*entries = (*r->prod_tail - *old_head + size) % size;
+			*entries = __rte_ring_distance(r, prod_tail, *old_head);
 
 			/* Set the actual entries for dequeue */
 			if (n > *entries)
@@ -230,151 +1034,920 @@ extern "C" {
 			if (unlikely(n == 0))
 				return 0;
 
-			*new_head = (*old_head + n) % size;
-			//if (is_sc)
-			//	*r->cons.head = *new_head, success = 1;
-			//else
-			success = __atomic_compare_exchange_n(r->cons_head,
-				old_head, *new_head,
-				0, __ATOMIC_ACQUIRE,
-				__ATOMIC_RELAXED);
+			*new_head = __rte_ring_wrap(r, *old_head + n);
+			RTE_RING_RESV_BEGIN(r, cons, *old_head, *new_head);
+			if (is_sc) {
+				*r->cons_head = *new_head, success = 1;
+				r->cons_shadow.head = *new_head;
+				r->cons_shadow.tail = prod_tail;
+			} else {
+				success = __atomic_compare_exchange_n(r->cons_head,
+					old_head, *new_head,
+					0, __ATOMIC_ACQUIRE,
+					__ATOMIC_RELAXED);
+				if (unlikely(success == 0)) {
+					RTE_RING_RESV_END(r, cons, RTE_RING_SYNC_MT);
+					RTE_RING_STAT_ADD(r, cons, cas_retry, 1);
+					__rte_ring_backoff(&backoff);
+				}
+			}
 		} while (unlikely(success == 0));
 		return n;
 	}
 
 	/**
-	 * @internal Enqueue several objects on the ring
-	 *
-	  * @param r
-	 *   A pointer to the ring structure.
-	 * @param obj_table
-	 *   A pointer to a table of void * pointers (objects).
-	 * @param n
-	 *   The number of objects to add in the ring from the obj_table.
-	 * @param behavior
-	 *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
-	 *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items as possible from ring
-	 * @param is_sp
-	 *   Indicates whether to use single producer or multi-producer head update
-	 * @param free_space
-	 *   returns the amount of space after the enqueue operation has finished
-	 * @return
-	 *   Actual number of objects enqueued.
-	 *   If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
-	 */
+	* @internal RTS version of __rte_ring_move_prod_head(). The head CAS
+	* also counts the producers that moved it.
+	*/
 	static __rte_always_inline unsigned int
-		__rte_ring_do_enqueue(struct rte_ring *r, void * obj_table,
-			unsigned int n, enum rte_ring_queue_behavior behavior)
+		__rte_ring_rts_move_prod_head(struct rte_ring *r, unsigned int n,
+			enum rte_ring_queue_behavior behavior,
+			rte_ring_idx_t *old_head, rte_ring_idx_t *new_head,
+			uint32_t *free_entries)
 	{
-		const uint32_t size = r->size;
-		int i = 0;
-		uint32_t prod_head, prod_next;
+		volatile uint64_t *head = (volatile uint64_t *)r->prod_head;
+		union __rte_ring_rts_poscnt oh, nh;
+		unsigned int max = n;
+		unsigned int backoff = 1;
+		rte_ring_idx_t cons_tail;
 
-		n = __rte_ring_move_prod_head(r, n, behavior,
-			&prod_head, &prod_next);
-		if (n == 0)
-			return n;
+		oh.raw = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+		for (;;) {
+			n = max;
+			cons_tail = __rte_ring_prod_limit(r, oh.val.pos);
+			*free_entries = r->capacity -
+				__rte_ring_distance(r, oh.val.pos, cons_tail);
+			if (unlikely(n > *free_entries))
+				n = (behavior == RTE_RING_QUEUE_FIXED) ?
+				0 : *free_entries;
+			if (n == 0) {
+				*old_head = *new_head = oh.val.pos;
+				return 0;
+			}
 
-		for (i = 0; i < n; i++)
-		{
-			printf("enqueue index:%d %d %d %d\n", (prod_head + i) % size, prod_head, i, size);
-			memcpy(r->data + ((prod_head + i) % size) * r->elemlen, obj_table + i*r->elemlen, r->elemlen);
+			nh.val.pos = __rte_ring_wrap(r, oh.val.pos + n);
+			nh.val.cnt = oh.val.cnt + 1;
+			if (likely(__atomic_compare_exchange_n(head, &oh.raw, nh.raw,
+					0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)))
+				break;
+			RTE_RING_STAT_ADD(r, prod, cas_retry, 1);
+			__rte_ring_backoff(&backoff);
 		}
-		//ENQUEUE_PTRS(r, &r[1], prod_head, obj_table, n, void *);//memcpy data to prod_head
-
-		update_tail(r->prod_head, r->prod_tail, prod_head, prod_next);
+		*old_head = oh.val.pos;
+		*new_head = nh.val.pos;
 		return n;
 	}
 
 	/**
-	 * @internal Dequeue several objects from the ring
-	 *
-	 * @param r
-	 *   A pointer to the ring structure.
-	 * @param obj_table
-	 *   A pointer to a table of void * pointers (objects).
-	 * @param n
-	 *   The number of objects to pull from the ring.
-	 * @param behavior
-	 *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
-	 *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items as possible from ring
-	 * @param is_sc
-	 *   Indicates whether to use single consumer or multi-consumer head update
-	 * @param available
-	 *   returns the number of remaining ring entries after the dequeue has finished
-	 * @return
-	 *   - Actual number of objects dequeued.
-	 *     If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
-	 */
+	* @internal RTS version of __rte_ring_move_cons_head().
+	*/
 	static __rte_always_inline unsigned int
-		__rte_ring_do_dequeue(struct rte_ring *r, void *obj_table,
-			unsigned int n, enum rte_ring_queue_behavior behavior)
+		__rte_ring_rts_move_cons_head(struct rte_ring *r, unsigned int n,
+			enum rte_ring_queue_behavior behavior,
+			rte_ring_idx_t *old_head, rte_ring_idx_t *new_head,
+			uint32_t *entries)
 	{
-		const uint32_t size = r->size;
-		uint32_t cons_head, cons_next;
-		uint32_t entries;
-		int i = 0;
-
-		n = __rte_ring_move_cons_head(r, n, behavior,
-			&cons_head, &cons_next, &entries);
-		if (n == 0)
-			return n;
-		for (i = 0; i < n; i++)
-		{
-			memcpy(obj_table + i*r->elemlen, r->data + ((cons_head + i) % size)* r->elemlen, r->elemlen);
-		}
+		volatile uint64_t *head = (volatile uint64_t *)r->cons_head;
+		union __rte_ring_rts_poscnt oh, nh;
+		unsigned int max = n;
+		unsigned int backoff = 1;
+		rte_ring_idx_t prod_tail;
 
-		update_tail(r->cons_head, r->cons_tail, cons_head, cons_next);
-		return n;
-	}
+		oh.raw = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+		for (;;) {
+			n = max;
+			prod_tail = __atomic_load_n(r->prod_tail, __ATOMIC_ACQUIRE);
+			*entries = __rte_ring_distance(r, prod_tail, oh.val.pos);
+			if (n > *entries)
+				n = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : *entries;
+			if (unlikely(n == 0)) {
+				*old_head = *new_head = oh.val.pos;
+				return 0;
+			}
+
+			nh.val.pos = __rte_ring_wrap(r, oh.val.pos + n);
+			nh.val.cnt = oh.val.cnt + 1;
+			if (likely(__atomic_compare_exchange_n(head, &oh.raw, nh.raw,
+					0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)))
+				break;
+			RTE_RING_STAT_ADD(r, cons, cas_retry, 1);
+			__rte_ring_backoff(&backoff);
+		}
+		*old_head = oh.val.pos;
+		*new_head = nh.val.pos;
+		return n;
+	}
+
+	/**
+	* @internal RTS tail update. Every finishing thread counts itself in
+	* the tail; the one that brings the count level with the head's also
+	* moves the tail to the head. Nobody waits, so a preempted thread only
+	* holds the tail back until it runs again.
+	*
+	* @return
+	*   The number of failed CAS.
+	*/
+	static __rte_always_inline unsigned int
+		__rte_ring_rts_update_tail(volatile rte_ring_idx_t *head_p,
+			volatile rte_ring_idx_t *tail_p)
+	{
+		volatile uint64_t *head = (volatile uint64_t *)head_p;
+		volatile uint64_t *tail = (volatile uint64_t *)tail_p;
+		union __rte_ring_rts_poscnt h, ot, nt;
+		unsigned int retries = 0;
+
+		ot.raw = __atomic_load_n(tail, __ATOMIC_ACQUIRE);
+		for (;;) {
+			h.raw = __atomic_load_n(head, __ATOMIC_RELAXED);
+			nt.raw = ot.raw;
+			if (++nt.val.cnt == h.val.cnt)
+				nt.val.pos = h.val.pos;
+			if (likely(__atomic_compare_exchange_n(tail, &ot.raw, nt.raw,
+					0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)))
+				return retries;
+			retries++;
+		}
+	}
+
+	/**
+	* @internal HTS version of __rte_ring_move_prod_head(). The head is
+	* only moved when it equals the tail, i.e. no other producer is in the
+	* middle of an enqueue.
+	*/
+	static __rte_always_inline unsigned int
+		__rte_ring_hts_move_prod_head(struct rte_ring *r, unsigned int n,
+			enum rte_ring_queue_behavior behavior,
+			rte_ring_idx_t *old_head, rte_ring_idx_t *new_head,
+			uint32_t *free_entries)
+	{
+		unsigned int max = n;
+		unsigned int backoff = 1;
+		rte_ring_idx_t cons_tail;
+
+		for (;;) {
+			n = max;
+			*old_head = __atomic_load_n(r->prod_head, __ATOMIC_ACQUIRE);
+			if (unlikely(*old_head !=
+					__atomic_load_n(r->prod_tail, __ATOMIC_ACQUIRE))) {
+				RTE_RING_STAT_ADD(r, prod, tail_spin, 1);
+				_mm_pause();
+				continue;
+			}
+			cons_tail = __rte_ring_prod_limit(r, *old_head);
+			*free_entries = r->capacity -
+				__rte_ring_distance(r, *old_head, cons_tail);
+			if (unlikely(n > *free_entries))
+				n = (behavior == RTE_RING_QUEUE_FIXED) ?
+				0 : *free_entries;
+			if (n == 0) {
+				*new_head = *old_head;
+				return 0;
+			}
+
+			*new_head = __rte_ring_wrap(r, *old_head + n);
+			if (likely(__atomic_compare_exchange_n(r->prod_head, old_head,
+					*new_head, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)))
+				return n;
+			RTE_RING_STAT_ADD(r, prod, cas_retry, 1);
+			__rte_ring_backoff(&backoff);
+		}
+	}
+
+	/**
+	* @internal HTS version of __rte_ring_move_cons_head().
+	*/
+	static __rte_always_inline unsigned int
+		__rte_ring_hts_move_cons_head(struct rte_ring *r, unsigned int n,
+			enum rte_ring_queue_behavior behavior,
+			rte_ring_idx_t *old_head, rte_ring_idx_t *new_head,
+			uint32_t *entries)
+	{
+		unsigned int max = n;
+		unsigned int backoff = 1;
+		rte_ring_idx_t prod_tail;
+
+		for (;;) {
+			n = max;
+			*old_head = __atomic_load_n(r->cons_head, __ATOMIC_ACQUIRE);
+			if (unlikely(*old_head !=
+					__atomic_load_n(r->cons_tail, __ATOMIC_ACQUIRE))) {
+				RTE_RING_STAT_ADD(r, cons, tail_spin, 1);
+				_mm_pause();
+				continue;
+			}
+			prod_tail = __atomic_load_n(r->prod_tail, __ATOMIC_ACQUIRE);
+			*entries = __rte_ring_distance(r, prod_tail, *old_head);
+			if (n > *entries)
+				n = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : *entries;
+			if (unlikely(n == 0)) {
+				*new_head = *old_head;
+				return 0;
+			}
+
+			*new_head = __rte_ring_wrap(r, *old_head + n);
+			if (likely(__atomic_compare_exchange_n(r->cons_head, old_head,
+					*new_head, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)))
+				return n;
+			RTE_RING_STAT_ADD(r, cons, cas_retry, 1);
+			__rte_ring_backoff(&backoff);
+		}
+	}
+
+	/**
+	 * @internal Copy n objects into the ring starting at head value prod_head.
+	 *
+	 * The destination is split at the end of r->data into at most two
+	 * contiguous segments, each moved by a single call to the copy routine
+	 * selected at creation.
+	 */
+	static __rte_always_inline void
+		__rte_ring_enqueue_elems(struct rte_ring *r, rte_ring_idx_t prod_head,
+			const void *obj_table, uint32_t n)
+	{
+		const size_t esize = r->elemlen;
+		const uint32_t idx = __rte_ring_slot(r, prod_head);
+		char *ring = (char *)r->data;
+		const char *obj = (const char *)obj_table;
+
+		if (likely(idx + n <= r->size)) {
+			r->enq_copy(ring + idx * esize, obj, n * esize);
+		} else {
+			const uint32_t first = r->size - idx;
+
+			r->enq_copy(ring + idx * esize, obj, first * esize);
+			r->enq_copy(ring, obj + first * esize, (n - first) * esize);
+		}
+	}
+
+	/**
+	 * @internal Copy n objects out of the ring starting at head value
+	 * cons_head, in at most two contiguous segments.
+	 */
+	static __rte_always_inline void
+		__rte_ring_dequeue_elems(struct rte_ring *r, rte_ring_idx_t cons_head,
+			void *obj_table, uint32_t n)
+	{
+		const size_t esize = r->elemlen;
+		const uint32_t idx = __rte_ring_slot(r, cons_head);
+		const char *ring = (const char *)r->data;
+		char *obj = (char *)obj_table;
+
+		if (likely(idx + n <= r->size)) {
+			r->deq_copy(obj, ring + idx * esize, n * esize);
+		} else {
+			const uint32_t first = r->size - idx;
+
+			r->deq_copy(obj, ring + idx * esize, first * esize);
+			r->deq_copy(obj + first * esize, ring, (n - first) * esize);
+		}
+	}
+
+	/**
+	 * @internal Reserve room for n objects; the caller then copies them in
+	 * and publishes them with __rte_ring_enqueue_finish().
+	 */
+	static __rte_always_inline unsigned int
+		__rte_ring_enqueue_start(struct rte_ring *r, unsigned int is_sp,
+			unsigned int n, enum rte_ring_queue_behavior behavior,
+			rte_ring_idx_t *prod_head, rte_ring_idx_t *prod_next,
+			uint32_t *free_entries)
+	{
+		switch (is_sp) {
+		case RTE_RING_SYNC_MT_RTS:
+			n = __rte_ring_rts_move_prod_head(r, n, behavior,
+				prod_head, prod_next, free_entries);
+			break;
+		case RTE_RING_SYNC_MT_HTS:
+			n = __rte_ring_hts_move_prod_head(r, n, behavior,
+				prod_head, prod_next, free_entries);
+			break;
+		default:
+			n = __rte_ring_move_prod_head(r, is_sp, n, behavior,
+				prod_head, prod_next, free_entries);
+		}
+		RTE_RING_TRACE_EVENT(r, RTE_RING_TRACE_ENQ, *prod_head, n);
+		if (n != 0) {
+			RTE_RING_STAT_ADD(r, prod, enq_calls, 1);
+			RTE_RING_STAT_ADD(r, prod, enq_objs, n);
+			RTE_RING_STAT_OCC(r, r->capacity - *free_entries + n);
+		} else
+			RTE_RING_STAT_ADD(r, prod, enq_fail, 1);
+		return n;
+	}
+
+	/**
+	 * @internal Make objects reserved by __rte_ring_enqueue_start() visible
+	 * to consumers.
+	 */
+	static __rte_always_inline void
+		__rte_ring_enqueue_finish(struct rte_ring *r, rte_ring_idx_t prod_head,
+			rte_ring_idx_t prod_next, unsigned int is_sp)
+	{
+		unsigned int spins;
+
+		RTE_RING_LAT_STAMP(r, prod_head, prod_next);
+		if (is_sp == RTE_RING_SYNC_MT_RTS)
+			spins = __rte_ring_rts_update_tail(r->prod_head, r->prod_tail);
+		else
+			spins = update_tail(r->prod_tail, prod_head, prod_next,
+				is_sp != RTE_RING_SYNC_MT);
+		RTE_RING_RESV_END(r, prod, is_sp);
+		if (unlikely(spins != 0))
+			RTE_RING_STAT_ADD(r, prod, tail_spin, spins);
+		if (unlikely(r->flags & RING_F_WAIT))
+			__rte_ring_wake(r->prod_tail, r->prod_waiters);
+		if (unlikely(r->ready_word != NULL))
+			__rte_ring_notify_enq(r, prod_head, is_sp);
+	}
+
+	/**
+	 * @internal Claim n objects; the caller then copies them out and
+	 * releases the slots with __rte_ring_dequeue_finish().
+	 */
+	static __rte_always_inline unsigned int
+		__rte_ring_dequeue_start(struct rte_ring *r, unsigned int is_sc,
+			unsigned int n, enum rte_ring_queue_behavior behavior,
+			rte_ring_idx_t *cons_head, rte_ring_idx_t *cons_next,
+			uint32_t *entries)
+	{
+		switch (is_sc) {
+		case RTE_RING_SYNC_MT_RTS:
+			n = __rte_ring_rts_move_cons_head(r, n, behavior,
+				cons_head, cons_next, entries);
+			break;
+		case RTE_RING_SYNC_MT_HTS:
+			n = __rte_ring_hts_move_cons_head(r, n, behavior,
+				cons_head, cons_next, entries);
+			break;
+		default:
+			n = __rte_ring_move_cons_head(r, is_sc, n, behavior,
+				cons_head, cons_next, entries);
+		}
+		RTE_RING_TRACE_EVENT(r, RTE_RING_TRACE_DEQ, *cons_head, n);
+		if (n != 0) {
+			RTE_RING_STAT_ADD(r, cons, deq_calls, 1);
+			RTE_RING_STAT_ADD(r, cons, deq_objs, n);
+		} else
+			RTE_RING_STAT_ADD(r, cons, deq_fail, 1);
+		return n;
+	}
+
+	/**
+	 * @internal Hand slots claimed by __rte_ring_dequeue_start() back to
+	 * producers.
+	 */
+	static __rte_always_inline void
+		__rte_ring_dequeue_finish(struct rte_ring *r, rte_ring_idx_t cons_head,
+			rte_ring_idx_t cons_next, unsigned int is_sc)
+	{
+		unsigned int spins;
+
+		RTE_RING_LAT_RECORD(r, cons_head, cons_next);
+		if (is_sc == RTE_RING_SYNC_MT_RTS)
+			spins = __rte_ring_rts_update_tail(r->cons_head, r->cons_tail);
+		else
+			spins = update_tail(r->cons_tail, cons_head, cons_next,
+				is_sc != RTE_RING_SYNC_MT);
+		RTE_RING_RESV_END(r, cons, is_sc);
+		if (unlikely(spins != 0))
+			RTE_RING_STAT_ADD(r, cons, tail_spin, spins);
+		if (unlikely(r->flags & RING_F_WAIT))
+			__rte_ring_wake(r->cons_tail, r->cons_waiters);
+	}
+
+	/**
+	 * @internal Count the slots from index pos, up to n, whose sequence is
+	 * their index plus off: 0 when free for that index, 1 when full.
+	 */
+	static __rte_always_inline unsigned int
+		__rte_ring_slot_seq_run(const struct rte_ring *r, rte_ring_idx_t pos,
+			unsigned int n, uint32_t off)
+	{
+		unsigned int i;
+
+		for (i = 0; i < n; i++)
+			if (__atomic_load_n(&r->seq[(pos + i) & r->mask],
+					__ATOMIC_ACQUIRE) != pos + i + off)
+				break;
+		return i;
+	}
+
+	/**
+	 * @internal Claim up to n slots at head whose sequence is index + off,
+	 * with a CAS unless single is set. Once the CAS succeeds the slots are
+	 * ours: their sequences only change again when we publish them.
+	 *
+	 * @return
+	 *   The number of slots claimed; *pos returns the first index.
+	 */
+	static __rte_always_inline unsigned int
+		__rte_ring_slot_seq_claim(struct rte_ring *r,
+			volatile rte_ring_idx_t *head,
+			unsigned int single, unsigned int n,
+			enum rte_ring_queue_behavior behavior, uint32_t off,
+			rte_ring_idx_t *pos, uint64_t *retries)
+	{
+		const unsigned int max = n;
+		unsigned int backoff = 1;
+		rte_ring_idx_t cur;
+
+		*pos = __atomic_load_n(head, __ATOMIC_RELAXED);
+		for (;;) {
+			n = __rte_ring_slot_seq_run(r, *pos, max, off);
+			if (n < max && (behavior == RTE_RING_QUEUE_FIXED || n == 0)) {
+				/* full or empty, unless *pos was stale */
+				cur = __atomic_load_n(head, __ATOMIC_RELAXED);
+				if (cur == *pos)
+					return 0;
+				*pos = cur;
+				continue;
+			}
+			if (single) {
+				__atomic_store_n(head, *pos + n, __ATOMIC_RELAXED);
+				return n;
+			}
+			if (__atomic_compare_exchange_n(head, pos, *pos + n, 0,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				return n;
+			(*retries)++;
+			__rte_ring_backoff(&backoff);
+		}
+	}
+
+	/**
+	 * @internal Entries between two heads of a RING_F_SLOT_SEQ ring, read
+	 * at different times, clamped to [0, capacity].
+	 */
+	static __rte_always_inline uint32_t
+		__rte_ring_slot_seq_count_between(const struct rte_ring *r,
+			rte_ring_idx_t prod, rte_ring_idx_t cons)
+	{
+		const rte_ring_idx_t d = prod - cons;
+
+		if (d > (rte_ring_idx_t)-1 / 2)
+			return 0;
+		return d > r->capacity ? r->capacity : (uint32_t)d;
+	}
+
+	/** @internal __rte_ring_do_enqueue() of a RING_F_SLOT_SEQ ring. */
+	static __rte_always_inline unsigned int
+		__rte_ring_slot_seq_enqueue(struct rte_ring *r, const void *obj_table,
+			unsigned int n, enum rte_ring_queue_behavior behavior,
+			unsigned int is_sp, unsigned int *free_space)
+	{
+		uint64_t retries = 0;
+		rte_ring_idx_t pos;
+		uint32_t i;
+
+		n = __rte_ring_slot_seq_claim(r, r->prod_head,
+			is_sp == RTE_RING_SYNC_ST, n, behavior, 0, &pos, &retries);
+		RTE_RING_TRACE_EVENT(r, RTE_RING_TRACE_ENQ, pos, n);
+		if (unlikely(retries != 0))
+			RTE_RING_STAT_ADD(r, prod, cas_retry, retries);
+
+		if (n != 0) {
+			__rte_ring_enqueue_elems(r, pos, obj_table, n);
+			RTE_RING_LAT_STAMP(r, pos, pos + n);
+			for (i = 0; i < n; i++)
+				__atomic_store_n(&r->seq[(pos + i) & r->mask],
+					pos + i + 1, __ATOMIC_RELEASE);
+			if (unlikely(r->ready_word != NULL))
+				__rte_ring_notify(r);
+			RTE_RING_STAT_ADD(r, prod, enq_calls, 1);
+			RTE_RING_STAT_ADD(r, prod, enq_objs, n);
+			RTE_RING_STAT_OCC(r, __rte_ring_slot_seq_count_between(r, pos + n,
+				__atomic_load_n(r->cons_head, __ATOMIC_RELAXED)));
+		} else
+			RTE_RING_STAT_ADD(r, prod, enq_fail, 1);
+
+		if (free_space != NULL)
+			*free_space = r->capacity - __rte_ring_slot_seq_count_between(r,
+				pos + n, __atomic_load_n(r->cons_head, __ATOMIC_RELAXED));
+		return n;
+	}
+
+	/** @internal __rte_ring_do_dequeue() of a RING_F_SLOT_SEQ ring. */
+	static __rte_always_inline unsigned int
+		__rte_ring_slot_seq_dequeue(struct rte_ring *r, void *obj_table,
+			unsigned int n, enum rte_ring_queue_behavior behavior,
+			unsigned int is_sc, unsigned int *available)
+	{
+		uint64_t retries = 0;
+		rte_ring_idx_t pos;
+		uint32_t i;
+
+		n = __rte_ring_slot_seq_claim(r, r->cons_head,
+			is_sc == RTE_RING_SYNC_ST, n, behavior, 1, &pos, &retries);
+		RTE_RING_TRACE_EVENT(r, RTE_RING_TRACE_DEQ, pos, n);
+		if (unlikely(retries != 0))
+			RTE_RING_STAT_ADD(r, cons, cas_retry, retries);
+
+		if (n != 0) {
+			__rte_ring_dequeue_elems(r, pos, obj_table, n);
+			RTE_RING_LAT_RECORD(r, pos, pos + n);
+			/* free each slot for the index one lap later */
+			for (i = 0; i < n; i++)
+				__atomic_store_n(&r->seq[(pos + i) & r->mask],
+					pos + i + r->size, __ATOMIC_RELEASE);
+			RTE_RING_STAT_ADD(r, cons, deq_calls, 1);
+			RTE_RING_STAT_ADD(r, cons, deq_objs, n);
+		} else
+			RTE_RING_STAT_ADD(r, cons, deq_fail, 1);
+
+		if (available != NULL)
+			*available = __rte_ring_slot_seq_count_between(r,
+				__atomic_load_n(r->prod_head, __ATOMIC_RELAXED), pos + n);
+		return n;
+	}
+
+	/**
+	 * @internal Enqueue several objects on the ring
+	 *
+	  * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects).
+	 * @param n
+	 *   The number of objects to add in the ring from the obj_table.
+	 * @param behavior
+	 *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+	 *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items as possible from ring
+	 * @param is_sp
+	 *   Indicates whether to use single producer or multi-producer head update
+	 * @param free_space
+	 *   if non-NULL, returns the amount of space after the enqueue operation
+	 *   has finished
+	 * @return
+	 *   Actual number of objects enqueued.
+	 *   If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
+	 */
+	static __rte_always_inline unsigned int
+		__rte_ring_do_enqueue(struct rte_ring *r, void * obj_table,
+			unsigned int n, enum rte_ring_queue_behavior behavior,
+			unsigned int is_sp, unsigned int *free_space)
+	{
+		rte_ring_idx_t prod_head, prod_next;
+		uint32_t free_entries;
+
+		if (r->flags & RING_F_SLOT_SEQ)
+			return __rte_ring_slot_seq_enqueue(r, obj_table, n, behavior,
+				is_sp, free_space);
+
+		n = __rte_ring_enqueue_start(r, is_sp, n, behavior,
+			&prod_head, &prod_next, &free_entries);
+		if (n == 0)
+			goto end;
+
+		__rte_ring_enqueue_elems(r, prod_head, obj_table, n);
+
+		__rte_ring_enqueue_finish(r, prod_head, prod_next, is_sp);
+end:
+		if (free_space != NULL)
+			*free_space = free_entries - n;
+		return n;
+	}
+
+	/**
+	 * @internal Dequeue several objects from the ring
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects).
+	 * @param n
+	 *   The number of objects to pull from the ring.
+	 * @param behavior
+	 *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
+	 *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items as possible from ring
+	 * @param is_sc
+	 *   Indicates whether to use single consumer or multi-consumer head update
+	 * @param available
+	 *   if non-NULL, returns the number of remaining ring entries after the
+	 *   dequeue has finished
+	 * @return
+	 *   - Actual number of objects dequeued.
+	 *     If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
+	 */
+	static __rte_always_inline unsigned int
+		__rte_ring_do_dequeue(struct rte_ring *r, void *obj_table,
+			unsigned int n, enum rte_ring_queue_behavior behavior,
+			unsigned int is_sc, unsigned int *available)
+	{
+		rte_ring_idx_t cons_head, cons_next;
+		uint32_t entries;
+
+		if (r->flags & RING_F_SLOT_SEQ)
+			return __rte_ring_slot_seq_dequeue(r, obj_table, n, behavior,
+				is_sc, available);
+
+		n = __rte_ring_dequeue_start(r, is_sc, n, behavior,
+			&cons_head, &cons_next, &entries);
+		if (n == 0)
+			goto end;
+
+		__rte_ring_dequeue_elems(r, cons_head, obj_table, n);
+
+		__rte_ring_dequeue_finish(r, cons_head, cons_next, is_sc);
+end:
+		if (available != NULL)
+			*available = entries - n;
+		return n;
+	}
+
+	/**
+	 * Enqueue several objects on the ring (multi-producers safe).
+	 *
+	 * This function uses a "compare and set" instruction to move the
+	 * producer index atomically.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects).
+	 * @param n
+	 *   The number of objects to add in the ring from the obj_table.
+	 * @param free_space
+	 *   if non-NULL, returns the amount of space in the ring after the
+	 *   enqueue operation has finished.
+	 * @return
+	 *   The number of objects enqueued, either 0 or n
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_mp_enqueue_bulk(struct rte_ring *r, void * obj_table,
+			unsigned int n, unsigned int *free_space)
+	{
+		return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED,
+			RTE_RING_SYNC_MT, free_space);
+	}
+
+	/**
+	 * Enqueue several objects on a ring (NOT multi-producers safe).
+	 *
+	 * The producer head is moved with a plain store and the tail is
+	 * published with a store-release, without waiting for other producers.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects).
+	 * @param n
+	 *   The number of objects to add in the ring from the obj_table.
+	 * @param free_space
+	 *   if non-NULL, returns the amount of space in the ring after the
+	 *   enqueue operation has finished.
+	 * @return
+	 *   The number of objects enqueued, either 0 or n
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_sp_enqueue_bulk(struct rte_ring *r, void * obj_table,
+			unsigned int n, unsigned int *free_space)
+	{
+		return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED,
+			RTE_RING_SYNC_ST, free_space);
+	}
+
+	/**
+	 * Enqueue several objects on a ring.
+	 *
+	 * This function calls the multi-producer or the single-producer
+	 * version depending on the default behavior that was specified at
+	 * ring creation time (see flags).
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects).
+	 * @param n
+	 *   The number of objects to add in the ring from the obj_table.
+	 * @param free_space
+	 *   if non-NULL, returns the amount of space in the ring after the
+	 *   enqueue operation has finished.
+	 * @return
+	 *   The number of objects enqueued, either 0 or n
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_enqueue_bulk(struct rte_ring *r, void * obj_table,
+			unsigned int n, unsigned int *free_space)
+	{
+		return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED,
+			r->prod_sync_type, free_space);
+	}
+
+	/**
+	 * Enqueue as many objects as possible on the ring (multi-producers safe).
+	 *
+	 * This function uses a "compare and set" instruction to move the
+	 * producer index atomically.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects).
+	 * @param n
+	 *   The number of objects to add in the ring from the obj_table.
+	 * @param free_space
+	 *   if non-NULL, returns the amount of space in the ring after the
+	 *   enqueue operation has finished.
+	 * @return
+	 *   - n: Actual number of objects enqueued.
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_mp_enqueue_burst(struct rte_ring *r, void * obj_table,
+			unsigned int n, unsigned int *free_space)
+	{
+		return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE,
+			RTE_RING_SYNC_MT, free_space);
+	}
+
+	/**
+	 * Enqueue as many objects as possible on a ring (NOT multi-producers safe).
+	 *
+	 * The producer head is moved with a plain store and the tail is
+	 * published with a store-release, without waiting for other producers.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects).
+	 * @param n
+	 *   The number of objects to add in the ring from the obj_table.
+	 * @param free_space
+	 *   if non-NULL, returns the amount of space in the ring after the
+	 *   enqueue operation has finished.
+	 * @return
+	 *   - n: Actual number of objects enqueued.
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_sp_enqueue_burst(struct rte_ring *r, void * obj_table,
+			unsigned int n, unsigned int *free_space)
+	{
+		return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE,
+			RTE_RING_SYNC_ST, free_space);
+	}
+
+	/**
+	 * Enqueue as many objects as possible on a ring.
+	 *
+	 * This function calls the multi-producer or the single-producer
+	 * version depending on the default behavior that was specified at
+	 * ring creation time (see flags).
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects).
+	 * @param n
+	 *   The number of objects to add in the ring from the obj_table.
+	 * @param free_space
+	 *   if non-NULL, returns the amount of space in the ring after the
+	 *   enqueue operation has finished.
+	 * @return
+	 *   - n: Actual number of objects enqueued.
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_enqueue_burst(struct rte_ring *r, void * obj_table,
+			unsigned int n, unsigned int *free_space)
+	{
+		return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE,
+			r->prod_sync_type, free_space);
+	}
+
+	/**
+	 * Enqueue one object on a ring (multi-producers safe).
+	 *
+	 * This function uses a "compare and set" instruction to move the
+	 * producer index atomically.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj
+	 *   A pointer to the object to be added.
+	 * @return
+	 *   The number of objects enqueued, either 0 or 1
+	 */
+	static __rte_always_inline int
+		rte_ring_mp_enqueue(struct rte_ring *r, void *obj)
+	{
+		return rte_ring_mp_enqueue_bulk(r, obj, 1, NULL);
+	}
+
+	/**
+	 * Enqueue one object on a ring (NOT multi-producers safe).
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj
+	 *   A pointer to the object to be added.
+	 * @return
+	 *   The number of objects enqueued, either 0 or 1
+	 */
+	static __rte_always_inline int
+		rte_ring_sp_enqueue(struct rte_ring *r, void *obj)
+	{
+		return rte_ring_sp_enqueue_bulk(r, obj, 1, NULL);
+	}
+
+	/**
+	 * Enqueue one object on a ring.
+	 *
+	 * This function calls the multi-producer or the single-producer
+	 * version, depending on the default behaviour that was specified at
+	 * ring creation time (see flags).
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj
+	 *   A pointer to the object to be added.
+	 * @return
+	 *   The number of objects enqueued, either 0 or 1
+	 */
+	static __rte_always_inline int
+		rte_ring_enqueue(struct rte_ring *r, void *obj)
+	{
+		return rte_ring_enqueue_bulk(r, obj, 1, NULL);
+	}
+
+	/**
+	 * Dequeue several objects from a ring (multi-consumers safe).
+	 *
+	 * This function uses a "compare and set" instruction to move the
+	 * consumer index atomically.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects) that will be filled.
+	 * @param n
+	 *   The number of objects to dequeue from the ring to the obj_table.
+	 * @param available
+	 *   If non-NULL, returns the number of remaining ring entries after the
+	 *   dequeue has finished.
+	 * @return
+	 *   The number of objects dequeued, either 0 or n
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_mc_dequeue_bulk(struct rte_ring *r, void *obj_table,
+			unsigned int n, unsigned int *available)
+	{
+		return __rte_ring_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED,
+			RTE_RING_SYNC_MT, available);
+	}
 
 	/**
-	 * Enqueue several objects on the ring (multi-producers safe).
+	 * Dequeue several objects from a ring (NOT multi-consumers safe).
 	 *
-	 * This function uses a "compare and set" instruction to move the
-	 * producer index atomically.
+	 * The consumer head is moved with a plain store and the tail is
+	 * published with a store-release, without waiting for other consumers.
 	 *
 	 * @param r
 	 *   A pointer to the ring structure.
 	 * @param obj_table
-	 *   A pointer to a table of void * pointers (objects).
+	 *   A pointer to a table of void * pointers (objects) that will be filled.
 	 * @param n
-	 *   The number of objects to add in the ring from the obj_table.
-	 * @param free_space
-	 *   if non-NULL, returns the amount of space in the ring after the
-	 *   enqueue operation has finished.
+	 *   The number of objects to dequeue from the ring to the obj_table.
+	 * @param available
+	 *   If non-NULL, returns the number of remaining ring entries after the
+	 *   dequeue has finished.
 	 * @return
-	 *   The number of objects enqueued, either 0 or n
+	 *   The number of objects dequeued, either 0 or n
 	 */
 	static __rte_always_inline unsigned int
-		rte_ring_enqueue_bulk(struct rte_ring *r, void * obj_table,
-			unsigned int n)
+		rte_ring_sc_dequeue_bulk(struct rte_ring *r, void *obj_table,
+			unsigned int n, unsigned int *available)
 	{
-		return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+		return __rte_ring_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED,
+			RTE_RING_SYNC_ST, available);
 	}
 
 	/**
-	 * Enqueue one object on a ring (multi-producers safe).
+	 * Dequeue several objects from a ring.
 	 *
-	 * This function uses a "compare and set" instruction to move the
-	 * producer index atomically.
+	 * This function calls the multi-consumers or the single-consumer
+	 * version, depending on the default behaviour that was specified at
+	 * ring creation time (see flags).
 	 *
 	 * @param r
 	 *   A pointer to the ring structure.
-	 * @param obj
-	 *   A pointer to the object to be added.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects) that will be filled.
+	 * @param n
+	 *   The number of objects to dequeue from the ring to the obj_table.
+	 * @param available
+	 *   If non-NULL, returns the number of remaining ring entries after the
+	 *   dequeue has finished.
 	 * @return
-	 *   - 0: Success; objects enqueued.
-	 _*   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+	 *   The number of objects dequeued, either 0 or n
 	 */
-	static __rte_always_inline int
-		rte_ring_enqueue(struct rte_ring *r, void *obj)
+	static __rte_always_inline unsigned int
+		rte_ring_dequeue_bulk(struct rte_ring *r, void *obj_table,
+			unsigned int n, unsigned int *available)
 	{
-		return rte_ring_enqueue_bulk(r, obj, 1);
+		return __rte_ring_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED,
+			r->cons_sync_type, available);
 	}
 
 	/**
-	 * Dequeue several objects from a ring (multi-consumers safe).
+	 * Dequeue as many objects as possible from a ring (multi-consumers safe).
 	 *
 	 * This function uses a "compare and set" instruction to move the
 	 * consumer index atomically.
@@ -389,67 +1962,455 @@ extern "C" {
 	 *   If non-NULL, returns the number of remaining ring entries after the
 	 *   dequeue has finished.
 	 * @return
-	 *   The number of objects dequeued, either 0 or n
+	 *   - n: Actual number of objects dequeued, 0 if ring is empty
 	 */
 	static __rte_always_inline unsigned int
-		rte_ring_dequeue_bulk(struct rte_ring *r, void *obj_table,
-			unsigned int n)
+		rte_ring_mc_dequeue_burst(struct rte_ring *r, void *obj_table,
+			unsigned int n, unsigned int *available)
+	{
+		return __rte_ring_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE,
+			RTE_RING_SYNC_MT, available);
+	}
+
+	/**
+	 * Dequeue as many objects as possible from a ring (NOT multi-consumers safe).
+	 *
+	 * The consumer head is moved with a plain store and the tail is
+	 * published with a store-release, without waiting for other consumers.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects) that will be filled.
+	 * @param n
+	 *   The number of objects to dequeue from the ring to the obj_table.
+	 * @param available
+	 *   If non-NULL, returns the number of remaining ring entries after the
+	 *   dequeue has finished.
+	 * @return
+	 *   - n: Actual number of objects dequeued, 0 if ring is empty
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_sc_dequeue_burst(struct rte_ring *r, void *obj_table,
+			unsigned int n, unsigned int *available)
+	{
+		return __rte_ring_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE,
+			RTE_RING_SYNC_ST, available);
+	}
+
+	/**
+	 * Dequeue as many objects as possible from a ring.
+	 *
+	 * This function calls the multi-consumers or the single-consumer
+	 * version, depending on the default behaviour that was specified at
+	 * ring creation time (see flags).
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_table
+	 *   A pointer to a table of void * pointers (objects) that will be filled.
+	 * @param n
+	 *   The number of objects to dequeue from the ring to the obj_table.
+	 * @param available
+	 *   If non-NULL, returns the number of remaining ring entries after the
+	 *   dequeue has finished.
+	 * @return
+	 *   - n: Actual number of objects dequeued, 0 if ring is empty
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_dequeue_burst(struct rte_ring *r, void *obj_table,
+			unsigned int n, unsigned int *available)
 	{
-		return __rte_ring_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+		return __rte_ring_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE,
+			r->cons_sync_type, available);
 	}
 
 	/**
 	 * Dequeue one object from a ring (multi-consumers safe).
 	 *
-	 * This function uses a "compare and set" instruction to move the
-	 * consumer index atomically.
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_p
+	 *   A pointer to a void * pointer (object) that will be filled.
+	 * @return
+	 *   The number of objects dequeued, either 0 or 1
+	 */
+	static __rte_always_inline int
+		rte_ring_mc_dequeue(struct rte_ring *r, void *obj_p)
+	{
+		return rte_ring_mc_dequeue_bulk(r, obj_p, 1, NULL);
+	}
+
+	/**
+	 * Dequeue one object from a ring (NOT multi-consumers safe).
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param obj_p
+	 *   A pointer to a void * pointer (object) that will be filled.
+	 * @return
+	 *   The number of objects dequeued, either 0 or 1
+	 */
+	static __rte_always_inline int
+		rte_ring_sc_dequeue(struct rte_ring *r, void *obj_p)
+	{
+		return rte_ring_sc_dequeue_bulk(r, obj_p, 1, NULL);
+	}
+
+	/**
+	 * Dequeue one object from a ring.
+	 *
+	 * This function calls the multi-consumers or the single-consumer
+	 * version depending on the default behaviour that was specified at
+	 * ring creation time (see flags).
 	 *
 	 * @param r
 	 *   A pointer to the ring structure.
 	 * @param obj_p
 	 *   A pointer to a void * pointer (object) that will be filled.
 	 * @return
-	 *   - 0: Success; objects dequeued.
-	 *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
-	 *     dequeued.
+	 *   The number of objects dequeued, either 0 or 1
 	 */
 	static __rte_always_inline int
 		rte_ring_dequeue(struct rte_ring *r, void *obj_p)
 	{
-		return rte_ring_dequeue_bulk(r, obj_p, 1);
+		return rte_ring_dequeue_bulk(r, obj_p, 1, NULL);
 	}
 
 	/**
-	* @param r
-	*  A pointer to the ring structure.
+	 * Prefetch the objects the next dequeue will return, so that they are
+	 * in cache by then. Call it one poll iteration early, before working
+	 * on the previous batch. Only the objects already in the ring are
+	 * prefetched; nothing is dequeued.
+	 *
+	 * Not for broadcast rings, whose readers have their own cursors. On
+	 * RING_F_SLOT_SEQ rings, which publish no producer tail, the objects
+	 * claimed by producers are prefetched, written or not.
+	 *
+	 * The copy kernels of rte_ring_copy.h also prefetch ahead within a
+	 * burst, but elements that no kernel handles, such as those below
+	 * RTE_RING_COPY_MIN_SIMD bytes, are copied with memcpy() and rely on
+	 * this call and the hardware prefetchers.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param n
+	 *   The number of objects the next dequeue will ask for.
+	 */
+	static __rte_always_inline void
+		rte_ring_prefetch_next(const struct rte_ring *r, unsigned int n)
+	{
+		const rte_ring_idx_t head = __atomic_load_n(r->cons_head, __ATOMIC_RELAXED);
+		const uint32_t entries = (r->flags & RING_F_SLOT_SEQ) ?
+			__rte_ring_slot_seq_count_between(r,
+				__atomic_load_n(r->prod_head, __ATOMIC_RELAXED), head) :
+			__rte_ring_distance(r,
+				__atomic_load_n(r->prod_tail, __ATOMIC_RELAXED), head);
+		const size_t ring_len = (size_t)r->size * r->elemlen;
+		const char *ring = (const char *)r->data;
+		size_t off, end;
+
+		if (n > entries)
+			n = entries;
+		off = (size_t)__rte_ring_slot(r, head) * r->elemlen;
+		end = off + (size_t)n * r->elemlen;
+		for (off &= ~(size_t)(RTE_CACHE_LINE_SIZE - 1); off < end;
+			off += RTE_CACHE_LINE_SIZE)
+			__builtin_prefetch(ring + (off < ring_len ? off : off - ring_len),
+				0, 3);
+	}
+
+	/**
+	* @internal Fill the process-local ring structure for a shared memory.
+	*/
+	static inline void
+		__rte_ring_init_local(struct rte_ring *r, void *p, uint32_t size,
+			uint32_t elemlen, unsigned int flags)
+	{
+		r->size = size;
+		if (flags & RING_F_POW2_SZ) {
+			/* free-running counters can use every slot */
+			r->mask = r->size - 1;
+			r->capacity = r->size;
+		} else {
+			r->mask = r->size - 1;
+			r->capacity = r->size - 1;
+		}
+		r->elemlen = elemlen;
+		r->flags = flags;
+		if (flags & RING_F_SP_ENQ)
+			r->prod_sync_type = RTE_RING_SYNC_ST;
+		else if (flags & RING_F_MP_RTS_ENQ)
+			r->prod_sync_type = RTE_RING_SYNC_MT_RTS;
+		else if (flags & RING_F_MP_HTS_ENQ)
+			r->prod_sync_type = RTE_RING_SYNC_MT_HTS;
+		else
+			r->prod_sync_type = RTE_RING_SYNC_MT;
+		if (flags & RING_F_SC_DEQ)
+			r->cons_sync_type = RTE_RING_SYNC_ST;
+		else if (flags & RING_F_MC_RTS_DEQ)
+			r->cons_sync_type = RTE_RING_SYNC_MT_RTS;
+		else if (flags & RING_F_MC_HTS_DEQ)
+			r->cons_sync_type = RTE_RING_SYNC_MT_HTS;
+		else
+			r->cons_sync_type = RTE_RING_SYNC_MT;
+
+		r->prod_head = (volatile rte_ring_idx_t*)p;
+		r->prod_tail = (volatile rte_ring_idx_t*)((char*)p + RTE_RING_INDEX_PAD);
+		r->cons_head = (volatile rte_ring_idx_t*)((char*)p + 2 * RTE_RING_INDEX_PAD);
+		r->cons_tail = (volatile rte_ring_idx_t*)((char*)p + 3 * RTE_RING_INDEX_PAD);
+		r->prod_waiters = (volatile uint32_t*)
+			((char*)r->prod_tail + RTE_RING_WAITERS_OFFSET);
+		r->cons_waiters = (volatile uint32_t*)
+			((char*)r->cons_tail + RTE_RING_WAITERS_OFFSET);
+		r->hdr = (struct rte_ring_shm_hdr*)((char*)p + RTE_RING_SHM_HDR_OFFSET);
+		r->data = (char*)p + RTE_RING_HDR_SIZE;
+		r->enq_copy = rte_ring_copy_select(elemlen, r->data,
+			flags & RING_F_NT_ENQ);
+		r->deq_copy = rte_ring_copy_select(elemlen, NULL, 0);
+		r->map_len = 0;
+		r->stats = RTE_RING_STATS_SHARDS == 0 ? NULL :
+			(struct rte_ring_stats_shard*)((char*)p + RTE_RING_STATS_OFFSET);
+		r->owners = RTE_RING_OWNERS == 0 ? NULL :
+			(struct rte_ring_owner*)((char*)p + RTE_RING_OWNERS_OFFSET);
+		r->lat = RTE_RING_LAT_STAMPS == 0 ? NULL :
+			(struct rte_ring_lat*)((char*)p + RTE_RING_LAT_OFFSET);
+		r->bcast = !(flags & RING_F_BCAST) ? NULL :
+			(struct rte_ring_bcast_cursor*)((char*)r->data +
+				RTE_RING_DATA_SIZE(size, elemlen));
+		r->seq = !(flags & (RING_F_LOSSY | RING_F_SLOT_SEQ)) ? NULL :
+			(volatile rte_ring_idx_t*)((char*)r->data +
+				RTE_RING_DATA_SIZE(size, elemlen));
+		r->ready_word = NULL;
+		r->ready_bit = 0;
+		r->prod_shadow.head = *r->prod_head;
+		r->prod_shadow.tail = (flags & RING_F_BCAST) ?
+			r->prod_shadow.head - r->capacity :
+			__atomic_load_n(r->cons_tail, __ATOMIC_ACQUIRE);
+		r->cons_shadow.head = *r->cons_head;
+		r->cons_shadow.tail = __atomic_load_n(r->prod_tail, __ATOMIC_ACQUIRE);
+	}
+
+	/**
+	* @internal Allocate a process-local ring structure, aligned so that the
+	* producer and consumer lines are not shared.
+	*/
+	static inline struct rte_ring *
+		__rte_ring_alloc(void)
+	{
+		void *r;
+
+		if (posix_memalign(&r, RTE_RING_INDEX_PAD, sizeof(struct rte_ring)) != 0)
+			return NULL;
+		return (struct rte_ring*)r;
+	}
+
+	/**
+	* Size of the shared memory needed by a ring.
+	*
+	* @param count
+	*   Number of slots of the ring
+	* @param elemlen
+	*   size of the element
+	* @return
+	*   The value to pass as totallen to rte_ring_create().
+	*/
+	static inline size_t
+		rte_ring_get_memsize(unsigned int count, unsigned int elemlen)
+	{
+		return RTE_RING_HDR_SIZE + (size_t)count * elemlen;
+	}
+
+	/**
+	* Size of the shared memory needed by a ring with a sequence number per
+	* slot (RING_F_SLOT_SEQ, or a lossy ring).
+	*
+	* @param count
+	*   Number of slots of the ring, a power of two
+	* @param elemlen
+	*   size of the element
+	*/
+	static inline size_t
+		rte_ring_slot_seq_get_memsize(unsigned int count, unsigned int elemlen)
+	{
+		return RTE_RING_HDR_SIZE + RTE_RING_DATA_SIZE(count, elemlen) +
+			(size_t)count * sizeof(rte_ring_idx_t);
+	}
+
+	/**
+	* @internal Most slots of a ring with sequence numbers that fit in
+	* totallen bytes, before rounding to a power of two; 0 if none does.
+	*/
+	static inline uint32_t
+		__rte_ring_slot_seq_size(size_t totallen, uint32_t elemlen)
+	{
+		size_t size;
+
+		if (elemlen == 0 || totallen <= RTE_RING_HDR_SIZE)
+			return 0;
+		size = (totallen - RTE_RING_HDR_SIZE) /
+			(elemlen + sizeof(rte_ring_idx_t));
+		while (size != 0 &&
+			rte_ring_slot_seq_get_memsize(size, elemlen) > totallen)
+			size--;
+		return size > UINT32_MAX ? 0 : (uint32_t)size;
+	}
+
+	/**
+	* @internal Create a ring of size slots in the first totallen bytes of
+	* p, followed by readers broadcast cursors for RING_F_BCAST.
+	*/
+	static inline struct rte_ring *
+		__rte_ring_create(void* p, size_t totallen, uint32_t size,
+			uint32_t elemlen, unsigned int flags, uint32_t readers)
+	{
+		struct rte_ring* r;
+		struct rte_ring_shm_hdr* hdr;
+		uint32_t i;
+
+		if (size == 0 || elemlen == 0)
+			return NULL;
+		r = __rte_ring_alloc();
+		if (r == NULL)
+			return NULL;
+		if (__builtin_popcount(flags &
+				(RING_F_SP_ENQ | RING_F_MP_RTS_ENQ | RING_F_MP_HTS_ENQ)) > 1 ||
+			__builtin_popcount(flags &
+				(RING_F_SC_DEQ | RING_F_MC_RTS_DEQ | RING_F_MC_HTS_DEQ)) > 1 ||
+			(flags & (RING_F_BCAST | RING_F_LOSSY)) ==
+				(RING_F_BCAST | RING_F_LOSSY) ||
+			(sizeof(rte_ring_idx_t) != sizeof(uint32_t) &&
+				(flags & (RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ))) ||
+			((flags & RING_F_SLOT_SEQ) && (flags & (RING_F_MP_RTS_ENQ |
+				RING_F_MC_RTS_DEQ | RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ |
+				RING_F_WAIT | RING_F_MSG | RING_F_BCAST | RING_F_LOSSY)))) {
+			free(r);
+			return NULL;
+		}
+		if (flags & RING_F_POW2_SZ)
+			size = 1u << (31 - __builtin_clz(size));
+
+		memset(p, 0, totallen);
+		__rte_ring_init_local(r, p, size, elemlen, flags);
+
+		hdr = r->hdr;
+		hdr->magic = RTE_RING_SHM_MAGIC;
+		hdr->version = RTE_RING_SHM_VERSION;
+		hdr->size = size;
+		hdr->elemlen = elemlen;
+		hdr->flags = flags;
+		hdr->index_pad = RTE_RING_INDEX_PAD;
+		hdr->stats_shards = RTE_RING_STATS_SHARDS;
+		hdr->readers = readers;
+		hdr->index_size = sizeof(rte_ring_idx_t);
+		hdr->owners = RTE_RING_OWNERS;
+		hdr->lat_stamps = RTE_RING_LAT_STAMPS;
+		hdr->lat_sample = RTE_RING_LAT_SAMPLE;
+		for (i = 0; i < readers; i++)
+			r->bcast[i].active = 1;
+		if (flags & RING_F_SLOT_SEQ)
+			for (i = 0; i < size; i++)
+				r->seq[i] = i;
+		__atomic_store_n(&hdr->init_done, 1, __ATOMIC_RELEASE);
+		return r;
+	}
+
+	/**
+	* Create a new ring in a shared memory. The whole buffer is reset.
+	*
 	* @param p
 	*  A pointer to a shared memory
 	* @param totalen
 	*  size of the shared memory
 	* @param elemlen
 	*  size of the element
+	* @param flags
+	*   An OR of the following:
+	*   - RING_F_SP_ENQ: If this flag is set, the default behavior when
+	*     using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
+	*     is "single-producer". Otherwise, it is "multi-producers".
+	*   - RING_F_SC_DEQ: If this flag is set, the default behavior when
+	*     using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
+	*     is "single-consumer". Otherwise, it is "multi-consumers".
+	*   - RING_F_POW2_SZ: If this flag is set, the number of slots is
+	*     rounded down to a power of two and indexes are masked instead of
+	*     being reduced modulo the size.
+	*   - RING_F_NT_ENQ: If this flag is set, wide elements are copied into
+	*     the ring with non-temporal stores.
+	*   - RING_F_WAIT: If this flag is set, threads can block in
+	*     rte_ring_dequeue_wait() / rte_ring_enqueue_wait().
+	*   - RING_F_MP_RTS_ENQ / RING_F_MP_HTS_ENQ: If one of these flags is
+	*     set, the default enqueue is multi-producer with relaxed tail sync
+	*     or head/tail sync. Such rings must only be used through
+	*     ``rte_ring_enqueue*()``, not ``rte_ring_mp_enqueue*()``.
+	*   - RING_F_MC_RTS_DEQ / RING_F_MC_HTS_DEQ: Same for dequeue.
+	*   At most one of the sync flags of each side may be given.
+	*   - RING_F_SLOT_SEQ: Use the slot sequence engine; totallen should
+	*     come from rte_ring_slot_seq_get_memsize(). Implies RING_F_POW2_SZ,
+	*     and excludes the sync flags above and RING_F_WAIT.
+	* @return
+	*   The ring, or NULL on error, e.g. if totallen does not hold a slot.
 	*/
 	struct rte_ring *
-		rte_ring_create(void* p, int totallen, int elemlen)
+		rte_ring_create(void* p, int totallen, int elemlen, unsigned int flags)
 	{
-		struct rte_ring* r = malloc(sizeof(struct rte_ring));
-		r->size = (totallen - 512) / elemlen;//64*4 global cons_head,cons_tail,prod_head,prod_tail;
-		r->mask = r->size - 1;
-		r->capacity = r->size - 1;
-		r->elemlen = elemlen;
+		uint32_t size;
+
+		if (elemlen <= 0 || totallen <= (int)RTE_RING_HDR_SIZE)
+			return NULL;
+		size = (totallen - RTE_RING_HDR_SIZE) / elemlen;//64*4 global cons_head,cons_tail,prod_head,prod_tail;
+		if (flags & RING_F_SLOT_SEQ) {
+			size = __rte_ring_slot_seq_size(totallen, elemlen);
+			if (size == 0)
+				return NULL;
+			flags |= RING_F_POW2_SZ;
+		}
+		return __rte_ring_create(p, totallen, size, elemlen,
+			flags & ~(RING_F_BCAST | RING_F_LOSSY), 0);
+	}
+	/**
+	* Map an existing ring, created by rte_ring_create() possibly in another
+	* process, without resetting it. The ring geometry and flags are read
+	* from the header in the shared memory.
+	*
+	* @param p
+	*  A pointer to the shared memory holding the ring
+	* @return
+	*   The ring, to be freed with rte_ring_free(), or NULL if p does not
+	*   hold a fully initialized ring of a supported version.
+	*/
+	struct rte_ring *
+		rte_ring_attach(void* p)
+	{
+		const struct rte_ring_shm_hdr* hdr = (const struct rte_ring_shm_hdr*)
+			((char*)p + RTE_RING_SHM_HDR_OFFSET);
+		struct rte_ring* r;
 
-		r->prod_head = p;
-		r->prod_tail = p + 64;
-		r->cons_head = p + 128;
-		r->cons_tail = p + 192;
-		r->data = p + 512;
+		if (__atomic_load_n(&hdr->init_done, __ATOMIC_ACQUIRE) == 0 ||
+			hdr->magic != RTE_RING_SHM_MAGIC ||
+			hdr->version != RTE_RING_SHM_VERSION ||
+			hdr->index_pad != RTE_RING_INDEX_PAD ||
+			hdr->stats_shards != RTE_RING_STATS_SHARDS ||
+			hdr->index_size != sizeof(rte_ring_idx_t) ||
+			hdr->owners != RTE_RING_OWNERS ||
+			hdr->lat_stamps != RTE_RING_LAT_STAMPS ||
+			hdr->lat_sample != RTE_RING_LAT_SAMPLE)
+			return NULL;
+		if (hdr->size == 0 || hdr->elemlen == 0)
+			return NULL;
+		if ((hdr->flags & RING_F_POW2_SZ) && (hdr->size & (hdr->size - 1)))
+			return NULL;
 
-		memset(p, 0, totallen);
+		r = __rte_ring_alloc();
+		if (r == NULL)
+			return NULL;
+		__rte_ring_init_local(r, p, hdr->size, hdr->elemlen, hdr->flags);
 		return r;
 	}
 
 	/**
-	* De-allocate all memory used by the ring.
+	* De-allocate all memory used by the ring. The shared memory itself is
+	* left untouched.
 	*
 	* @param r
 	*   Ring to free
@@ -461,12 +2422,365 @@ extern "C" {
 		return;
 	}
 
+	/** Snapshot of the ring state, see rte_ring_get_info(). */
+	struct rte_ring_info {
+		uint32_t size;           /**< Size of ring. */
+		uint32_t capacity;       /**< Usable size of ring */
+		uint32_t usage;          /**< Entries between cons_head and prod_head */
+		uint32_t count;          /**< Entries between cons_tail and prod_tail */
+		rte_ring_idx_t prod_head;
+		rte_ring_idx_t prod_tail;
+		rte_ring_idx_t cons_head;
+		rte_ring_idx_t cons_tail;
+	};
+
+	/**
+	* Take a snapshot of the ring indexes without formatting anything.
+	*
+	* The indexes are read one by one with relaxed loads, so the snapshot is
+	* only consistent when the ring is idle.
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	* @param info
+	*   Filled with the current ring state.
+	*/
+	static inline void
+		rte_ring_get_info(const struct rte_ring *r, struct rte_ring_info *info)
+	{
+		info->size = r->size;
+		info->capacity = r->capacity;
+		info->prod_head = __atomic_load_n(r->prod_head, __ATOMIC_RELAXED);
+		info->prod_tail = __atomic_load_n(r->prod_tail, __ATOMIC_RELAXED);
+		info->cons_head = __atomic_load_n(r->cons_head, __ATOMIC_RELAXED);
+		info->cons_tail = __atomic_load_n(r->cons_tail, __ATOMIC_RELAXED);
+		info->usage = __rte_ring_distance(r, info->prod_head, info->cons_head);
+		info->count = __rte_ring_distance(r, info->prod_tail, info->cons_tail);
+		if (r->flags & RING_F_SLOT_SEQ)
+			info->count = info->usage; /* the tails are not used */
+	}
+
+	/** Sum of the statistics counters of a ring, see rte_ring_get_stats(). */
+	struct rte_ring_stats {
+		uint64_t enq_calls;      /**< Enqueues that moved objects */
+		uint64_t enq_objs;       /**< Objects enqueued */
+		uint64_t enq_fail;       /**< Enqueues that found the ring full */
+		uint64_t prod_cas_retry; /**< Failed producer head CAS */
+		uint64_t prod_tail_spin; /**< Pauses of producers in the tail update */
+		uint64_t deq_calls;      /**< Dequeues that moved objects */
+		uint64_t deq_objs;       /**< Objects dequeued */
+		uint64_t deq_fail;       /**< Dequeues that found the ring empty */
+		uint64_t cons_cas_retry; /**< Failed consumer head CAS */
+		uint64_t cons_tail_spin; /**< Pauses of consumers in the tail update */
+		uint64_t hwm;            /**< Most entries seen after an enqueue */
+		/** Sampled entries after an enqueue; bucket b > 0 counts depths in
+		 * [2^(b-1), 2^b) */
+		uint64_t occ_hist[RTE_RING_OCC_BUCKETS];
+	};
+
+	/**
+	* Add up the statistics shards of a ring. Only the shard lines are
+	* read, never the index lines.
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	* @param stats
+	*   Filled with the counters.
+	* @return
+	*   0, or -1 if the ring was built without RTE_RING_STATS.
+	*/
+	static inline int
+		rte_ring_get_stats(const struct rte_ring *r, struct rte_ring_stats *stats)
+	{
+		const struct rte_ring_stats_shard *sh;
+		unsigned int i, b;
+		uint64_t hwm;
+
+		memset(stats, 0, sizeof(*stats));
+		if (r->stats == NULL)
+			return -1;
+		for (i = 0; i < r->hdr->stats_shards; i++) {
+			sh = &r->stats[i];
+			stats->enq_calls += __atomic_load_n(&sh->prod.enq_calls, __ATOMIC_RELAXED);
+			stats->enq_objs += __atomic_load_n(&sh->prod.enq_objs, __ATOMIC_RELAXED);
+			stats->enq_fail += __atomic_load_n(&sh->prod.enq_fail, __ATOMIC_RELAXED);
+			stats->prod_cas_retry += __atomic_load_n(&sh->prod.cas_retry, __ATOMIC_RELAXED);
+			stats->prod_tail_spin += __atomic_load_n(&sh->prod.tail_spin, __ATOMIC_RELAXED);
+			stats->deq_calls += __atomic_load_n(&sh->cons.deq_calls, __ATOMIC_RELAXED);
+			stats->deq_objs += __atomic_load_n(&sh->cons.deq_objs, __ATOMIC_RELAXED);
+			stats->deq_fail += __atomic_load_n(&sh->cons.deq_fail, __ATOMIC_RELAXED);
+			stats->cons_cas_retry += __atomic_load_n(&sh->cons.cas_retry, __ATOMIC_RELAXED);
+			stats->cons_tail_spin += __atomic_load_n(&sh->cons.tail_spin, __ATOMIC_RELAXED);
+			hwm = __atomic_load_n(&sh->prod.hwm, __ATOMIC_RELAXED);
+			if (hwm > stats->hwm)
+				stats->hwm = hwm;
+			for (b = 0; b < RTE_RING_OCC_BUCKETS; b++)
+				stats->occ_hist[b] += __atomic_load_n(&sh->prod.occ_hist[b],
+					__ATOMIC_RELAXED);
+		}
+		return 0;
+	}
+
+	/** Copy of the latency histogram of a ring, see rte_ring_get_latency(). */
+	struct rte_ring_latency {
+		uint64_t count;          /**< Samples */
+		uint64_t sum;            /**< Sum of the samples, in TSC cycles */
+		uint64_t max;            /**< Largest sample, in TSC cycles */
+		/** Bucket b counts samples from rte_ring_latency_bucket_min(b) */
+		uint64_t hist[RTE_RING_LAT_BUCKETS];
+	};
+
+	/**
+	* Read the enqueue-to-dequeue latency histogram of a ring. Like the
+	* statistics, it is only updated with -DRTE_RING_LATENCY.
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	* @param lat
+	*   Filled with the histogram; zeroed if there is none.
+	* @return
+	*   0, or -1 if the ring has no latency histogram.
+	*/
+	static inline int
+		rte_ring_get_latency(const struct rte_ring *r, struct rte_ring_latency *lat)
+	{
+		const struct rte_ring_lat_hist *h;
+		unsigned int b;
+
+		memset(lat, 0, sizeof(*lat));
+		if (r->lat == NULL)
+			return -1;
+		h = &r->lat->hist;
+		lat->count = __atomic_load_n(&h->count, __ATOMIC_RELAXED);
+		lat->sum = __atomic_load_n(&h->sum, __ATOMIC_RELAXED);
+		lat->max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+		for (b = 0; b < RTE_RING_LAT_BUCKETS; b++)
+			lat->hist[b] = __atomic_load_n(&h->buckets[b], __ATOMIC_RELAXED);
+		return 0;
+	}
+
+	/** Smallest latency, in cycles, counted in bucket b of the histogram. */
+	static inline uint64_t
+		rte_ring_latency_bucket_min(unsigned int b)
+	{
+		if (b < RTE_RING_LAT_SUB)
+			return b;
+		return (uint64_t)(RTE_RING_LAT_SUB + b % RTE_RING_LAT_SUB) <<
+			(b / RTE_RING_LAT_SUB - 1);
+	}
+
+	/**
+	* Latency under which a fraction q of the samples fall, to the
+	* resolution of the histogram (1/RTE_RING_LAT_SUB of the value).
+	*
+	* @param lat
+	*   A histogram from rte_ring_get_latency().
+	* @param q
+	*   Fraction of the samples, e.g. 0.99.
+	* @return
+	*   The lower bound of the bucket holding quantile q, in TSC cycles.
+	*/
+	static inline uint64_t
+		rte_ring_latency_quantile(const struct rte_ring_latency *lat, double q)
+	{
+		uint64_t seen = 0, rank;
+		unsigned int b;
+
+		if (lat->count == 0)
+			return 0;
+		rank = (uint64_t)(q * (double)lat->count);
+		if (rank >= lat->count)
+			rank = lat->count - 1;
+		for (b = 0; b < RTE_RING_LAT_BUCKETS; b++) {
+			seen += lat->hist[b];
+			if (seen > rank)
+				return rte_ring_latency_bucket_min(b);
+		}
+		return lat->max;
+	}
+
+#ifdef RTE_RING_RECOVERY
+	/**
+	 * @internal Finish the moves of dead threads on one side, oldest first.
+	 * The move at the tail is finished when every entry recording it is
+	 * dead; it ends where the next recorded move starts, or at the head.
+	 * -1 if a move in flight has no entry: its range cannot be told apart.
+	 */
+	static inline int
+		__rte_ring_recover_side(struct rte_ring *r, int prod, uint32_t *lost)
+	{
+		volatile rte_ring_idx_t *head = prod ? r->prod_head : r->cons_head;
+		volatile rte_ring_idx_t *tail = prod ? r->prod_tail : r->cons_tail;
+		const size_t esize = r->elemlen;
+		struct rte_ring_resv *res;
+		rte_ring_idx_t t, next;
+		uint32_t span, d, len, idx, first, i;
+		int found, alive, fixed = 0;
+
+		*lost = 0;
+		for (;;) {
+			t = __atomic_load_n(tail, __ATOMIC_ACQUIRE);
+			span = __rte_ring_distance(r, __atomic_load_n(head, __ATOMIC_ACQUIRE), t);
+			if (span == 0)
+				break;
+			if (__atomic_load_n(prod ? &r->hdr->prod_untracked :
+					&r->hdr->cons_untracked, __ATOMIC_SEQ_CST) != 0)
+				return -1;
+
+			found = alive = 0;
+			len = span;
+			for (i = 0; i < RTE_RING_OWNERS; i++) {
+				res = prod ? &r->owners[i].prod : &r->owners[i].cons;
+				if (!__atomic_load_n(&res->active, __ATOMIC_ACQUIRE))
+					continue;
+				d = __rte_ring_distance(r, res->old_head, t);
+				if (d == 0) {
+					found = 1;
+					alive |= __rte_ring_pid_alive(r->owners[i].pid);
+				} else if (d < len)
+					len = d;
+			}
+			if (!found || alive)
+				break;
+
+			if (prod) {
+				/* the dead producer may have written part of it */
+				idx = __rte_ring_slot(r, t);
+				first = idx + len <= r->size ? len : r->size - idx;
+				memset((char *)r->data + idx * esize, 0, first * esize);
+				memset(r->data, 0, (len - first) * esize);
+			}
+			next = __rte_ring_wrap(r, t + len);
+			if (!__atomic_compare_exchange_n(tail, &t, next, 0,
+					__ATOMIC_RELEASE, __ATOMIC_RELAXED))
+				continue;
+			for (i = 0; i < RTE_RING_OWNERS; i++) {
+				res = prod ? &r->owners[i].prod : &r->owners[i].cons;
+				if (res->active && res->old_head == t &&
+					!__rte_ring_pid_alive(r->owners[i].pid))
+					__atomic_store_n(&res->active, 0, __ATOMIC_RELEASE);
+			}
+			if (r->flags & RING_F_WAIT)
+				__rte_ring_wake(tail, prod ? r->prod_waiters : r->cons_waiters);
+			*lost += len;
+			fixed++;
+		}
+		return fixed;
+	}
+#endif
+
+	/**
+	* Repair a ring after a process using it died: finish the head moves it
+	* left in flight, on both sides, so that the threads waiting behind
+	* them go on. Objects being enqueued by a dead producer are published
+	* zero-filled; objects being dequeued by a dead consumer are lost. The
+	* entries of the owner table held by dead threads are freed.
+	*
+	* Call it from any process once the dead one is reaped, before starting
+	* its replacement. A move whose owner is still alive is left alone, so
+	* calling it when nothing died is harmless. Only MT and ST sides are
+	* repaired, not RTS/HTS and not the slot sequence, lossy and broadcast
+	* rings. Nothing is done while a move is in flight on a side without
+	* an owner table entry, because the table was full: raise
+	* RTE_RING_OWNERS above the number of threads using the ring.
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	* @param prod_lost
+	*   If non-NULL, returns the number of zero-filled objects published.
+	* @param cons_lost
+	*   If non-NULL, returns the number of objects dead consumers took.
+	* @return
+	*   The number of moves finished, or -1 if the ring cannot be repaired,
+	*   a move in flight is not in the owner table, or the ring was built
+	*   without RTE_RING_RECOVERY.
+	*/
+	static inline int
+		rte_ring_recover(struct rte_ring *r, uint32_t *prod_lost,
+			uint32_t *cons_lost)
+	{
+#ifdef RTE_RING_RECOVERY
+		struct rte_ring_owner *o;
+		uint32_t plost, clost, tid, i;
+		int fixed, c;
+
+		if (r->owners == NULL || r->prod_sync_type > RTE_RING_SYNC_ST ||
+			r->cons_sync_type > RTE_RING_SYNC_ST ||
+			(r->flags & (RING_F_SLOT_SEQ | RING_F_LOSSY | RING_F_BCAST)))
+			return -1;
+		fixed = __rte_ring_recover_side(r, 1, &plost);
+		if (fixed >= 0) {
+			c = __rte_ring_recover_side(r, 0, &clost);
+			fixed = c < 0 ? c : fixed + c;
+		}
+		if (fixed < 0)
+			return -1;
+
+		for (i = 0; i < RTE_RING_OWNERS; i++) {
+			o = &r->owners[i];
+			tid = __atomic_load_n(&o->tid, __ATOMIC_ACQUIRE);
+			if (tid == 0 || __rte_ring_pid_alive(o->pid))
+				continue;
+			/* moves the dead left behind a live one are kept for later */
+			if ((o->prod.active && __rte_ring_distance(r, o->prod.old_head,
+					*r->prod_tail) < __rte_ring_distance(r, *r->prod_head,
+					*r->prod_tail)) ||
+				(o->cons.active && __rte_ring_distance(r, o->cons.old_head,
+					*r->cons_tail) < __rte_ring_distance(r, *r->cons_head,
+					*r->cons_tail)))
+				continue;
+			o->prod.active = 0;
+			o->cons.active = 0;
+			__atomic_compare_exchange_n(&o->tid, &tid, 0, 0,
+				__ATOMIC_RELEASE, __ATOMIC_RELAXED);
+		}
+		if (prod_lost != NULL)
+			*prod_lost = plost;
+		if (cons_lost != NULL)
+			*cons_lost = clost;
+		return fixed;
+#else
+		(void)r;
+		(void)prod_lost;
+		(void)cons_lost;
+		return -1;
+#endif
+	}
+
+	/**
+	* Print a snapshot of the ring state to stdout.
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	*/
 	void
 		ring_info(struct rte_ring *r)
 	{
-		printf("ring size:%d\n", r->size);
-		printf("ring usage:%d\n", (*r->prod_head - *r->cons_head + r->size) % r->size);
-		printf("prod_head:%d, prod_tail:%d, cons_head:%d, cons_tail:%d\n", *r->prod_head, *r->prod_tail, *r->cons_head, *r->cons_tail);
+		struct rte_ring_info info;
+		struct rte_ring_stats stats;
+		struct rte_ring_latency lat;
+		unsigned int b;
+
+		rte_ring_get_info(r, &info);
+		printf("ring size:%u\n", info.size);
+		printf("ring usage:%u\n", info.usage);
+		printf("ring count:%u\n", info.count);
+		printf("prod_head:%" RTE_RING_PRIidx ", prod_tail:%" RTE_RING_PRIidx
+			", cons_head:%" RTE_RING_PRIidx ", cons_tail:%" RTE_RING_PRIidx "\n",
+			info.prod_head, info.prod_tail, info.cons_head, info.cons_tail);
+		if (rte_ring_get_latency(r, &lat) == 0 && lat.count != 0)
+			printf("latency cycles p50:%" PRIu64 " p99:%" PRIu64 " p99.9:%"
+				PRIu64 " max:%" PRIu64 " (%" PRIu64 " samples)\n",
+				rte_ring_latency_quantile(&lat, 0.5),
+				rte_ring_latency_quantile(&lat, 0.99),
+				rte_ring_latency_quantile(&lat, 0.999), lat.max, lat.count);
+		if (rte_ring_get_stats(r, &stats) != 0)
+			return;
+		printf("ring high-water mark:%" PRIu64 "\n", stats.hwm);
+		for (b = 0; b < RTE_RING_OCC_BUCKETS; b++)
+			if (stats.occ_hist[b] != 0)
+				printf("depth <%" PRIu64 ": %" PRIu64 "\n",
+					b == 0 ? 1 : (uint64_t)1 << b, stats.occ_hist[b]);
 	}
 
 #ifdef __cplusplus
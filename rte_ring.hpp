@@ -0,0 +1,326 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_HPP_
+#define _RTE_RING_HPP_
+
+/**
+* @file
+* RTE Ring, typed C++ interface
+*
+* rte::ring<T, Capacity> fixes the element type and the number of slots at
+* compile time, so objects are moved with plain typed loads and stores that
+* the compiler can unroll and vectorize instead of a generic memcpy of
+* r->elemlen bytes.
+*
+* The shared memory layout is the one built by rte_ring_create() with
+* RING_F_POW2_SZ, and head/tail updates go through the same C functions, so
+* a typed ring and a plain struct rte_ring can be used on the same buffer.
+*/
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdexcept>
+#include <type_traits>
+
+#include "rte_ring.h"
+
+namespace rte {
+
+	template <typename T, uint32_t Capacity>
+	class ring {
+		static_assert(std::is_trivially_copyable<T>::value,
+			"ring elements must be trivially copyable");
+		static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+			"ring capacity must be a power of two");
+
+	public:
+		static constexpr uint32_t capacity = Capacity;
+		static constexpr uint32_t mask = Capacity - 1;
+
+		/** Bytes of shared memory needed by the ring. */
+		static constexpr size_t memsize =
+			RTE_RING_HDR_SIZE + sizeof(T) * (size_t)Capacity;
+		static_assert(memsize <= INT_MAX,
+			"ring memory size must fit rte_ring_create()'s int length");
+
+		/**
+		* Create a new ring on a buffer of at least memsize bytes.
+		*
+		* @param p
+		*   A pointer to a shared memory
+		* @param flags
+		*   RING_F_SP_ENQ / RING_F_SC_DEQ, see rte_ring_create().
+		*   RING_F_POW2_SZ is always added.
+		*
+		* @throws std::invalid_argument
+		*   If flags select a layout the typed ring does not handle, or
+		*   rte_ring_create() rejects them.
+		*/
+		explicit ring(void *p, unsigned int flags = 0)
+			: r_(create(p, flags)), owned_(true)
+		{
+			data_ = static_cast<T *>(r_->data);
+		}
+
+		/**
+		* Use an existing ring, e.g. one created by rte_ring_create().
+		* The ring is not freed by this object.
+		*
+		* @throws std::invalid_argument
+		*   If the element size, the ring size or the indexing mode of r do
+		*   not match the template parameters.
+		*/
+		explicit ring(struct rte_ring *r)
+			: r_(r), owned_(false)
+		{
+			if (r == NULL || r->elemlen != sizeof(T) || r->size != Capacity ||
+				!(r->flags & RING_F_POW2_SZ) || (r->flags & untyped_flags))
+				throw std::invalid_argument("rte::ring: layout mismatch");
+			data_ = static_cast<T *>(r_->data);
+		}
+
+		ring(const ring &) = delete;
+		ring &operator=(const ring &) = delete;
+
+		~ring()
+		{
+			if (owned_)
+				rte_ring_free(r_);
+		}
+
+		/** The underlying C ring. */
+		struct rte_ring *c_ring() const { return r_; }
+
+		/** Same semantics as rte_ring_mp_enqueue_bulk(). */
+		unsigned int mp_enqueue_bulk(const T *obj_table, unsigned int n,
+			unsigned int *free_space = NULL)
+		{
+			return do_enqueue(obj_table, n, RTE_RING_QUEUE_FIXED,
+				RTE_RING_SYNC_MT, free_space);
+		}
+
+		/** Same semantics as rte_ring_sp_enqueue_bulk(). */
+		unsigned int sp_enqueue_bulk(const T *obj_table, unsigned int n,
+			unsigned int *free_space = NULL)
+		{
+			return do_enqueue(obj_table, n, RTE_RING_QUEUE_FIXED,
+				RTE_RING_SYNC_ST, free_space);
+		}
+
+		/** Same semantics as rte_ring_enqueue_bulk(). */
+		unsigned int enqueue_bulk(const T *obj_table, unsigned int n,
+			unsigned int *free_space = NULL)
+		{
+			return do_enqueue(obj_table, n, RTE_RING_QUEUE_FIXED,
+				r_->prod_sync_type, free_space);
+		}
+
+		/** Same semantics as rte_ring_mp_enqueue_burst(). */
+		unsigned int mp_enqueue_burst(const T *obj_table, unsigned int n,
+			unsigned int *free_space = NULL)
+		{
+			return do_enqueue(obj_table, n, RTE_RING_QUEUE_VARIABLE,
+				RTE_RING_SYNC_MT, free_space);
+		}
+
+		/** Same semantics as rte_ring_sp_enqueue_burst(). */
+		unsigned int sp_enqueue_burst(const T *obj_table, unsigned int n,
+			unsigned int *free_space = NULL)
+		{
+			return do_enqueue(obj_table, n, RTE_RING_QUEUE_VARIABLE,
+				RTE_RING_SYNC_ST, free_space);
+		}
+
+		/** Same semantics as rte_ring_enqueue_burst(). */
+		unsigned int enqueue_burst(const T *obj_table, unsigned int n,
+			unsigned int *free_space = NULL)
+		{
+			return do_enqueue(obj_table, n, RTE_RING_QUEUE_VARIABLE,
+				r_->prod_sync_type, free_space);
+		}
+
+		/** Same semantics as rte_ring_enqueue(). */
+		int enqueue(const T &obj)
+		{
+			return enqueue_bulk(&obj, 1);
+		}
+
+		/** Same semantics as rte_ring_mc_dequeue_bulk(). */
+		unsigned int mc_dequeue_bulk(T *obj_table, unsigned int n,
+			unsigned int *available = NULL)
+		{
+			return do_dequeue(obj_table, n, RTE_RING_QUEUE_FIXED,
+				RTE_RING_SYNC_MT, available);
+		}
+
+		/** Same semantics as rte_ring_sc_dequeue_bulk(). */
+		unsigned int sc_dequeue_bulk(T *obj_table, unsigned int n,
+			unsigned int *available = NULL)
+		{
+			return do_dequeue(obj_table, n, RTE_RING_QUEUE_FIXED,
+				RTE_RING_SYNC_ST, available);
+		}
+
+		/** Same semantics as rte_ring_dequeue_bulk(). */
+		unsigned int dequeue_bulk(T *obj_table, unsigned int n,
+			unsigned int *available = NULL)
+		{
+			return do_dequeue(obj_table, n, RTE_RING_QUEUE_FIXED,
+				r_->cons_sync_type, available);
+		}
+
+		/** Same semantics as rte_ring_mc_dequeue_burst(). */
+		unsigned int mc_dequeue_burst(T *obj_table, unsigned int n,
+			unsigned int *available = NULL)
+		{
+			return do_dequeue(obj_table, n, RTE_RING_QUEUE_VARIABLE,
+				RTE_RING_SYNC_MT, available);
+		}
+
+		/** Same semantics as rte_ring_sc_dequeue_burst(). */
+		unsigned int sc_dequeue_burst(T *obj_table, unsigned int n,
+			unsigned int *available = NULL)
+		{
+			return do_dequeue(obj_table, n, RTE_RING_QUEUE_VARIABLE,
+				RTE_RING_SYNC_ST, available);
+		}
+
+		/** Same semantics as rte_ring_dequeue_burst(). */
+		unsigned int dequeue_burst(T *obj_table, unsigned int n,
+			unsigned int *available = NULL)
+		{
+			return do_dequeue(obj_table, n, RTE_RING_QUEUE_VARIABLE,
+				r_->cons_sync_type, available);
+		}
+
+		/** Same semantics as rte_ring_dequeue(). */
+		int dequeue(T &obj)
+		{
+			return dequeue_bulk(&obj, 1);
+		}
+
+	private:
+		/* Flags whose ring layout or semantics the typed copies bypass */
+		static constexpr unsigned int untyped_flags =
+			RING_F_MSG | RING_F_BCAST | RING_F_LOSSY | RING_F_SLOT_SEQ;
+
+		static struct rte_ring *
+			create(void *p, unsigned int flags)
+		{
+			struct rte_ring *r;
+
+			if (flags & untyped_flags)
+				throw std::invalid_argument("rte::ring: unsupported flags");
+			r = rte_ring_create(p, (int)memsize, (int)sizeof(T),
+				flags | RING_F_POW2_SZ);
+			if (r == NULL)
+				throw std::invalid_argument("rte::ring: invalid flags");
+			if (r->size != Capacity) {
+				rte_ring_free(r);
+				throw std::invalid_argument("rte::ring: layout mismatch");
+			}
+			return r;
+		}
+
+		/*
+		* Copy n objects between the ring and a table, 4 at a time, in at
+		* most two contiguous segments.
+		*/
+		static __rte_always_inline void
+			copy_elems(T *__restrict dst, const T *__restrict src,
+				unsigned int n)
+		{
+			unsigned int i = 0;
+
+			for (; i + 4 <= n; i += 4) {
+				dst[i] = src[i];
+				dst[i + 1] = src[i + 1];
+				dst[i + 2] = src[i + 2];
+				dst[i + 3] = src[i + 3];
+			}
+			switch (n - i) {
+			case 3: dst[i + 2] = src[i + 2]; /* fallthrough */
+			case 2: dst[i + 1] = src[i + 1]; /* fallthrough */
+			case 1: dst[i] = src[i];
+			}
+		}
+
+		__rte_always_inline void
+			enqueue_elems(rte_ring_idx_t prod_head, const T *obj_table,
+				unsigned int n)
+		{
+			const uint32_t idx = (uint32_t)(prod_head & mask);
+
+			if (likely(idx + n <= Capacity)) {
+				copy_elems(data_ + idx, obj_table, n);
+			} else {
+				const uint32_t first = Capacity - idx;
+
+				copy_elems(data_ + idx, obj_table, first);
+				copy_elems(data_, obj_table + first, n - first);
+			}
+		}
+
+		__rte_always_inline void
+			dequeue_elems(rte_ring_idx_t cons_head, T *obj_table, unsigned int n)
+		{
+			const uint32_t idx = (uint32_t)(cons_head & mask);
+
+			if (likely(idx + n <= Capacity)) {
+				copy_elems(obj_table, data_ + idx, n);
+			} else {
+				const uint32_t first = Capacity - idx;
+
+				copy_elems(obj_table, data_ + idx, first);
+				copy_elems(obj_table + first, data_, n - first);
+			}
+		}
+
+		__rte_always_inline unsigned int
+			do_enqueue(const T *obj_table, unsigned int n,
+				enum rte_ring_queue_behavior behavior, unsigned int is_sp,
+				unsigned int *free_space)
+		{
+			rte_ring_idx_t prod_head, prod_next;
+			uint32_t free_entries;
+
+			n = __rte_ring_enqueue_start(r_, is_sp, n, behavior,
+				&prod_head, &prod_next, &free_entries);
+			if (n != 0) {
+				enqueue_elems(prod_head, obj_table, n);
+				__rte_ring_enqueue_finish(r_, prod_head, prod_next, is_sp);
+			}
+			if (free_space != NULL)
+				*free_space = free_entries - n;
+			return n;
+		}
+
+		__rte_always_inline unsigned int
+			do_dequeue(T *obj_table, unsigned int n,
+				enum rte_ring_queue_behavior behavior, unsigned int is_sc,
+				unsigned int *available)
+		{
+			rte_ring_idx_t cons_head, cons_next;
+			uint32_t entries;
+
+			n = __rte_ring_dequeue_start(r_, is_sc, n, behavior,
+				&cons_head, &cons_next, &entries);
+			if (n != 0) {
+				dequeue_elems(cons_head, obj_table, n);
+				__rte_ring_dequeue_finish(r_, cons_head, cons_next, is_sc);
+			}
+			if (available != NULL)
+				*available = entries - n;
+			return n;
+		}
+
+		struct rte_ring *r_;
+		T *data_;
+		bool owned_;
+	};
+
+} /* namespace rte */
+
+#endif /* _RTE_RING_HPP_ */
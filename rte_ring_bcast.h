@@ -0,0 +1,174 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_BCAST_H_
+#define _RTE_RING_BCAST_H_
+
+/**
+* @file
+* RTE Ring broadcast
+*
+* A broadcast ring delivers every object to each of a fixed number of
+* readers, which may be in different processes, from a single copy in the
+* shared memory:
+*
+*   creator:   r = rte_ring_bcast_create(p, len, elemlen, 4, RING_F_SP_ENQ);
+*   producer:  rte_ring_enqueue_burst(r, objs, n, NULL);
+*   reader 2:  n = rte_ring_bcast_dequeue_burst(r, 2, objs, n, NULL);
+*
+* Each reader has its own cursor, on its own line after the ring data. The
+* producer never overwrites an object that an active reader has not read
+* yet, so the slowest reader sets the free space, like a Disruptor
+* sequence barrier. A reader that stops for good should call
+* rte_ring_bcast_leave() so it no longer holds the producer back.
+*
+* Any enqueue function can be used on a broadcast ring; the regular
+* dequeue functions and cons_head/cons_tail are not used.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rte_ring.h"
+
+	/**
+	* Size of the shared memory needed by a broadcast ring.
+	*
+	* @param count
+	*   Number of slots of the ring
+	* @param elemlen
+	*   size of the element
+	* @param readers
+	*   Number of readers
+	*/
+	static inline size_t
+		rte_ring_bcast_get_memsize(unsigned int count, unsigned int elemlen,
+			unsigned int readers)
+	{
+		return RTE_RING_HDR_SIZE + RTE_RING_DATA_SIZE(count, elemlen) +
+			(size_t)readers * sizeof(struct rte_ring_bcast_cursor);
+	}
+
+	/**
+	* Create a new broadcast ring in a shared memory. The whole buffer is
+	* reset and all readers start at the first object.
+	*
+	* @param p
+	*  A pointer to a shared memory
+	* @param totallen
+	*  size of the shared memory
+	* @param elemlen
+	*  size of the element
+	* @param readers
+	*  Number of readers, numbered from 0
+	* @param flags
+	*   Producer flags of rte_ring_create().
+	* @return
+	*   The ring, or NULL on error.
+	*/
+	static inline struct rte_ring *
+		rte_ring_bcast_create(void *p, size_t totallen, uint32_t elemlen,
+			uint32_t readers, unsigned int flags)
+	{
+		const size_t fixed = RTE_RING_HDR_SIZE +
+			(size_t)readers * sizeof(struct rte_ring_bcast_cursor);
+		size_t size;
+
+		if (readers == 0 || elemlen == 0 || totallen <= fixed)
+			return NULL;
+		/* the data is rounded up to a whole line before the cursors */
+		size = (totallen - fixed) / elemlen;
+		while (size != 0 &&
+			RTE_RING_DATA_SIZE(size, elemlen) > totallen - fixed)
+			size--;
+		if (size == 0 || size > UINT32_MAX)
+			return NULL;
+
+		return __rte_ring_create(p, totallen, (uint32_t)size, elemlen,
+			flags | RING_F_BCAST, readers);
+	}
+
+	/**
+	 * @internal Dequeue for one reader of a broadcast ring.
+	 */
+	static __rte_always_inline unsigned int
+		__rte_ring_bcast_do_dequeue(struct rte_ring *r, unsigned int reader,
+			void *obj_table, unsigned int n,
+			enum rte_ring_queue_behavior behavior, unsigned int *available)
+	{
+		struct rte_ring_bcast_cursor *c = &r->bcast[reader];
+		const rte_ring_idx_t pos = c->pos;
+		uint32_t entries;
+
+		entries = __rte_ring_distance(r,
+			__atomic_load_n(r->prod_tail, __ATOMIC_ACQUIRE), pos);
+		if (n > entries)
+			n = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : entries;
+
+		if (n != 0) {
+			__rte_ring_dequeue_elems(r, pos, obj_table, n);
+			/* the producer may reuse the slots once it sees this */
+			__atomic_store_n(&c->pos, __rte_ring_wrap(r, pos + n),
+				__ATOMIC_RELEASE);
+		}
+		if (available != NULL)
+			*available = entries - n;
+		return n;
+	}
+
+	/**
+	* Dequeue several objects for one reader of a broadcast ring. Each
+	* reader must be used by a single thread at a time.
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	* @param reader
+	*   The reader, below the number given at creation.
+	* @param obj_table
+	*   A pointer to a table of void * pointers (objects) that will be filled.
+	* @param n
+	*   The number of objects to dequeue from the ring to the obj_table.
+	* @param available
+	*   If non-NULL, returns the number of remaining entries for this
+	*   reader after the dequeue has finished.
+	* @return
+	*   The number of objects dequeued, either 0 or n
+	*/
+	static __rte_always_inline unsigned int
+		rte_ring_bcast_dequeue_bulk(struct rte_ring *r, unsigned int reader,
+			void *obj_table, unsigned int n, unsigned int *available)
+	{
+		return __rte_ring_bcast_do_dequeue(r, reader, obj_table, n,
+			RTE_RING_QUEUE_FIXED, available);
+	}
+
+	/**
+	* Dequeue up to n objects for one reader of a broadcast ring.
+	*
+	* @return
+	*   - n: Actual number of objects dequeued, 0 if the reader is up to
+	*     date.
+	*/
+	static __rte_always_inline unsigned int
+		rte_ring_bcast_dequeue_burst(struct rte_ring *r, unsigned int reader,
+			void *obj_table, unsigned int n, unsigned int *available)
+	{
+		return __rte_ring_bcast_do_dequeue(r, reader, obj_table, n,
+			RTE_RING_QUEUE_VARIABLE, available);
+	}
+
+	/**
+	* Stop a reader for good: the producer no longer waits for it.
+	*/
+	static inline void
+		rte_ring_bcast_leave(struct rte_ring *r, unsigned int reader)
+	{
+		__atomic_store_n(&r->bcast[reader].active, 0, __ATOMIC_RELEASE);
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_BCAST_H_ */
@@ -0,0 +1,351 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_CHAIN_H_
+#define _RTE_RING_CHAIN_H_
+
+/**
+* @file
+* RTE Ring chains
+*
+* A growable queue for bursty traffic: a list of fixed-size ring segments
+* taken from a pool in the same shared memory. The producer enqueues on its
+* current segment with the regular ring fast path; when it is full, it
+* takes a free segment, links it after the current one and goes on there.
+* The consumer follows the links once a segment is drained, and puts the
+* drained segment back in the pool. Memory in use follows the load, up to
+* max_segs segments:
+*
+*   creator:   c = rte_ring_chain_create(p, len, 1024, 64, 16);
+*   others:    c = rte_ring_chain_attach(p);
+*   producer:  rte_ring_chain_enqueue_burst(c, objs, n);
+*   consumer:  n = rte_ring_chain_dequeue_burst(c, objs, 32);
+*
+* A segment is never written again once it has a successor, so the
+* consumer switches with no lock: it drains the segment once more after
+* seeing the link, and moves on. The chain has a single producer and a
+* single consumer thread at a time, since a recycled segment could be
+* reused under a second one. Segments are taken from the pool lazily, so
+* the pages of the unused ones are not touched until the first burst that
+* needs them.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rte_ring_mempool.h"
+
+#define RTE_RING_CHAIN_MAGIC 0x43455452 /**< "RTEC" */
+
+	/** Chain description at the start of the shared memory. */
+	struct rte_ring_chain_hdr {
+		uint32_t magic;          /**< RTE_RING_CHAIN_MAGIC */
+		uint32_t elemlen;        /**< Element size */
+		uint32_t seg_slots;      /**< Slots of a segment, a power of two */
+		uint32_t init_done;      /**< Non-zero once the chain is usable */
+		/** Pool offset of the segment the producer writes */
+		uint32_t prod_seg __attribute__((aligned(RTE_RING_INDEX_PAD)));
+		/** Pool offset of the segment the consumer reads */
+		uint32_t cons_seg __attribute__((aligned(RTE_RING_INDEX_PAD)));
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	/** Segment header, followed by the segment ring. */
+	struct rte_ring_chain_seg {
+		uint32_t next;           /**< Pool offset of the next segment, or 0 */
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	/** Process-local handle of a chain. */
+	struct rte_ring_chain {
+		struct rte_ring_chain_hdr *hdr;
+		struct rte_ring_mempool *pool; /**< Free segments */
+		uint32_t prod_off;       /**< Segment of prod */
+		uint32_t cons_off;       /**< Segment of cons */
+		struct rte_ring *prod;   /**< Local ring of the producer segment */
+		struct rte_ring *cons;   /**< Local ring of the consumer segment */
+	};
+
+	/** @internal Bytes of one segment. */
+	static inline size_t
+		__rte_ring_chain_seg_len(unsigned int seg_slots, unsigned int elemlen)
+	{
+		return sizeof(struct rte_ring_chain_seg) +
+			rte_ring_get_memsize(seg_slots, elemlen);
+	}
+
+	/**
+	* Size of the shared memory needed by a chain.
+	*
+	* @param seg_slots
+	*   Slots of a segment, a power of two
+	* @param elemlen
+	*   size of the element
+	* @param max_segs
+	*   Most segments in use at once
+	*/
+	static inline size_t
+		rte_ring_chain_get_memsize(unsigned int seg_slots, unsigned int elemlen,
+			unsigned int max_segs)
+	{
+		return sizeof(struct rte_ring_chain_hdr) + rte_ring_mempool_get_memsize(
+			max_segs, (unsigned int)__rte_ring_chain_seg_len(seg_slots, elemlen));
+	}
+
+	/** @internal Segment at pool offset off. */
+	static __rte_always_inline struct rte_ring_chain_seg *
+		__rte_ring_chain_seg(const struct rte_ring_chain *c, uint32_t off)
+	{
+		return (struct rte_ring_chain_seg *)rte_ring_mempool_ptr(c->pool, off);
+	}
+
+	/**
+	* @internal Take a free segment and create an empty ring in it.
+	*
+	* @return
+	*   The pool offset of the segment, or 0 if the pool is empty.
+	*/
+	static inline uint32_t
+		__rte_ring_chain_seg_alloc(struct rte_ring_chain *c, struct rte_ring **r)
+	{
+		const struct rte_ring_chain_hdr *hdr = c->hdr;
+		struct rte_ring_chain_seg *seg;
+		uint32_t off;
+
+		if (rte_ring_mempool_get_bulk(c->pool, NULL, &off, 1) != 0)
+			return 0;
+		seg = __rte_ring_chain_seg(c, off);
+		seg->next = 0;
+		*r = rte_ring_create(seg + 1,
+			(int)rte_ring_get_memsize(hdr->seg_slots, hdr->elemlen),
+			(int)hdr->elemlen, RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_POW2_SZ);
+		if (*r == NULL) {
+			rte_ring_mempool_put_bulk(c->pool, NULL, &off, 1);
+			return 0;
+		}
+		return off;
+	}
+
+	/** @internal Map the current segments of the chain. */
+	static inline struct rte_ring_chain *
+		__rte_ring_chain_map(struct rte_ring_chain *c)
+	{
+		c->prod_off = __atomic_load_n(&c->hdr->prod_seg, __ATOMIC_ACQUIRE);
+		c->cons_off = __atomic_load_n(&c->hdr->cons_seg, __ATOMIC_ACQUIRE);
+		c->prod = rte_ring_attach(__rte_ring_chain_seg(c, c->prod_off) + 1);
+		c->cons = rte_ring_attach(__rte_ring_chain_seg(c, c->cons_off) + 1);
+		if (c->prod == NULL || c->cons == NULL) {
+			rte_ring_free(c->prod);
+			rte_ring_free(c->cons);
+			rte_ring_mempool_free(c->pool);
+			free(c);
+			return NULL;
+		}
+		return c;
+	}
+
+	/**
+	* Create a new chain, with one empty segment, in a shared memory.
+	*
+	* @param p
+	*  A pointer to a shared memory, aligned on RTE_RING_INDEX_PAD
+	* @param totallen
+	*  size of the shared memory, at least rte_ring_chain_get_memsize()
+	*  and at most 4 GB
+	* @param seg_slots
+	*  Slots of a segment, a power of two
+	* @param elemlen
+	*  size of the element
+	* @param max_segs
+	*  Most segments in use at once
+	* @return
+	*   The chain, to be freed with rte_ring_chain_free(), or NULL on error.
+	*/
+	static inline struct rte_ring_chain *
+		rte_ring_chain_create(void *p, size_t totallen, unsigned int seg_slots,
+			unsigned int elemlen, unsigned int max_segs)
+	{
+		struct rte_ring_chain_hdr *hdr = (struct rte_ring_chain_hdr *)p;
+		struct rte_ring_chain *c;
+		struct rte_ring *r;
+		uint32_t off;
+
+		if (seg_slots == 0 || (seg_slots & (seg_slots - 1)) != 0 ||
+			elemlen == 0 || max_segs == 0 ||
+			totallen < rte_ring_chain_get_memsize(seg_slots, elemlen, max_segs))
+			return NULL;
+		c = (struct rte_ring_chain *)calloc(1, sizeof(*c));
+		if (c == NULL)
+			return NULL;
+
+		memset(hdr, 0, sizeof(*hdr));
+		c->hdr = hdr;
+		c->pool = rte_ring_mempool_create(hdr + 1, totallen - sizeof(*hdr),
+			(unsigned int)__rte_ring_chain_seg_len(seg_slots, elemlen), max_segs);
+		if (c->pool == NULL) {
+			free(c);
+			return NULL;
+		}
+		hdr->magic = RTE_RING_CHAIN_MAGIC;
+		hdr->elemlen = elemlen;
+		hdr->seg_slots = seg_slots;
+
+		off = __rte_ring_chain_seg_alloc(c, &r);
+		if (off == 0) {
+			rte_ring_mempool_free(c->pool);
+			free(c);
+			return NULL;
+		}
+		rte_ring_free(r);
+		hdr->prod_seg = off;
+		hdr->cons_seg = off;
+		__atomic_store_n(&hdr->init_done, 1, __ATOMIC_RELEASE);
+		return __rte_ring_chain_map(c);
+	}
+
+	/**
+	* Map an existing chain, created by rte_ring_chain_create() possibly in
+	* another process.
+	*
+	* @param p
+	*  A pointer to the shared memory holding the chain
+	* @return
+	*   The chain, or NULL if p does not hold an initialized chain.
+	*/
+	static inline struct rte_ring_chain *
+		rte_ring_chain_attach(void *p)
+	{
+		struct rte_ring_chain_hdr *hdr = (struct rte_ring_chain_hdr *)p;
+		struct rte_ring_chain *c;
+
+		if (__atomic_load_n(&hdr->init_done, __ATOMIC_ACQUIRE) == 0 ||
+			hdr->magic != RTE_RING_CHAIN_MAGIC)
+			return NULL;
+		c = (struct rte_ring_chain *)calloc(1, sizeof(*c));
+		if (c == NULL)
+			return NULL;
+		c->hdr = hdr;
+		c->pool = rte_ring_mempool_attach(hdr + 1);
+		if (c->pool == NULL) {
+			free(c);
+			return NULL;
+		}
+		return __rte_ring_chain_map(c);
+	}
+
+	/**
+	* Free the process-local handle of a chain. The shared memory is left
+	* untouched.
+	*/
+	static inline void
+		rte_ring_chain_free(struct rte_ring_chain *c)
+	{
+		rte_ring_free(c->prod);
+		rte_ring_free(c->cons);
+		rte_ring_mempool_free(c->pool);
+		free(c);
+	}
+
+	/**
+	* Number of segments in use, between 1 and max_segs.
+	*/
+	static inline unsigned int
+		rte_ring_chain_segments(const struct rte_ring_chain *c)
+	{
+		return c->pool->hdr->obj_count - rte_ring_mempool_avail_count(c->pool);
+	}
+
+	/**
+	* Enqueue objects on a chain, adding segments while the current one is
+	* full.
+	*
+	* @param c
+	*   A chain, used by one producer thread.
+	* @param obj_table
+	*   A pointer to a table of objects.
+	* @param n
+	*   The number of objects to add in the chain from the obj_table.
+	* @return
+	*   The number of objects enqueued; fewer than n only once max_segs
+	*   segments are full.
+	*/
+	static __rte_always_inline unsigned int
+		rte_ring_chain_enqueue_burst(struct rte_ring_chain *c,
+			void *obj_table, unsigned int n)
+	{
+		const size_t esize = c->hdr->elemlen;
+		char *obj = (char *)obj_table;
+		unsigned int ret;
+		struct rte_ring *r;
+		uint32_t off;
+
+		ret = rte_ring_enqueue_burst(c->prod, obj, n, NULL);
+		while (unlikely(ret < n)) {
+			off = __rte_ring_chain_seg_alloc(c, &r);
+			if (off == 0)
+				break;
+			/* the consumer sees the objects of the old segment first */
+			__atomic_store_n(&__rte_ring_chain_seg(c, c->prod_off)->next, off,
+				__ATOMIC_RELEASE);
+			__atomic_store_n(&c->hdr->prod_seg, off, __ATOMIC_RELEASE);
+			rte_ring_free(c->prod);
+			c->prod = r;
+			c->prod_off = off;
+			ret += rte_ring_enqueue_burst(r, obj + ret * esize, n - ret, NULL);
+		}
+		return ret;
+	}
+
+	/**
+	* Dequeue up to n objects from a chain, moving to the next segment once
+	* the current one is drained.
+	*
+	* @param c
+	*   A chain, used by one consumer thread.
+	* @param obj_table
+	*   A pointer to a table of objects that will be filled.
+	* @param n
+	*   The maximum number of objects to dequeue.
+	* @return
+	*   - n: Actual number of objects dequeued, 0 if the chain is empty.
+	*/
+	static __rte_always_inline unsigned int
+		rte_ring_chain_dequeue_burst(struct rte_ring_chain *c, void *obj_table,
+			unsigned int n)
+	{
+		const size_t esize = c->hdr->elemlen;
+		char *obj = (char *)obj_table;
+		struct rte_ring_chain_seg *seg;
+		unsigned int ret;
+		struct rte_ring *r;
+		uint32_t next;
+
+		ret = rte_ring_dequeue_burst(c->cons, obj, n, NULL);
+		while (unlikely(ret < n)) {
+			seg = __rte_ring_chain_seg(c, c->cons_off);
+			next = __atomic_load_n(&seg->next, __ATOMIC_ACQUIRE);
+			if (next == 0)
+				break;
+			/* no more objects can come in this segment, take the last ones */
+			ret += rte_ring_dequeue_burst(c->cons, obj + ret * esize, n - ret,
+				NULL);
+			if (ret == n)
+				break;
+
+			r = rte_ring_attach(__rte_ring_chain_seg(c, next) + 1);
+			if (unlikely(r == NULL))
+				break;
+			__atomic_store_n(&c->hdr->cons_seg, next, __ATOMIC_RELEASE);
+			rte_ring_free(c->cons);
+			rte_ring_mempool_put_bulk(c->pool, NULL, &c->cons_off, 1);
+			c->cons = r;
+			c->cons_off = next;
+			ret += rte_ring_dequeue_burst(r, obj + ret * esize, n - ret, NULL);
+		}
+		return ret;
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_CHAIN_H_ */
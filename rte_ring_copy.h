@@ -0,0 +1,187 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_COPY_H_
+#define _RTE_RING_COPY_H_
+
+/**
+* @file
+* RTE Ring copy kernels
+*
+* Vector copy routines used to move wide elements in and out of the ring.
+* rte_ring_copy_select() picks one once, at ring creation, from the CPU
+* features and the element size; the hot path then makes a single indirect
+* call per contiguous segment.
+*
+* All kernels copy a length that is a multiple of their vector width.
+* Loads are unaligned. The streaming (non-temporal) kernels require an
+* aligned destination and end with an sfence, so the stores are globally
+* visible before the ring tail is published.
+*
+* Each kernel prefetches its source RTE_RING_PREFETCH_DIST bytes ahead, one
+* cache line at a time, so that a burst read from a ring larger than L2
+* does not stall on every line. -DRTE_RING_PREFETCH_DIST=0 turns it off.
+* Elements left to memcpy() get no such prefetch; rte_ring_prefetch_next()
+* covers them.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#ifndef RTE_RING_PREFETCH_DIST
+#define RTE_RING_PREFETCH_DIST 512 /**< Bytes prefetched ahead of a copy */
+#endif
+
+	/** Prefetch ahead of vector i of s, once per 64 B line of per vectors. */
+#define RTE_RING_COPY_PREFETCH(s, i, per) do { \
+		if (RTE_RING_PREFETCH_DIST != 0 && (i) % (per) == 0) \
+			__builtin_prefetch((const char *)((s) + (i)) + \
+				RTE_RING_PREFETCH_DIST, 0, 3); \
+	} while (0)
+
+	/** Copy routine, memcpy() compatible. */
+	typedef void *(*rte_ring_copy_t)(void *dst, const void *src, size_t len);
+
+	static void *
+		rte_ring_copy_sse2(void *dst, const void *src, size_t len)
+	{
+		__m128i *d = (__m128i *)dst;
+		const __m128i *s = (const __m128i *)src;
+		size_t i;
+
+		for (i = 0; i < len / 16; i++) {
+			RTE_RING_COPY_PREFETCH(s, i, 4);
+			_mm_storeu_si128(d + i, _mm_loadu_si128(s + i));
+		}
+		return dst;
+	}
+
+	static void *
+		rte_ring_copy_sse2_nt(void *dst, const void *src, size_t len)
+	{
+		__m128i *d = (__m128i *)dst;
+		const __m128i *s = (const __m128i *)src;
+		size_t i;
+
+		for (i = 0; i < len / 16; i++) {
+			RTE_RING_COPY_PREFETCH(s, i, 4);
+			_mm_stream_si128(d + i, _mm_loadu_si128(s + i));
+		}
+		_mm_sfence();
+		return dst;
+	}
+
+	__attribute__((target("avx2"))) static void *
+		rte_ring_copy_avx2(void *dst, const void *src, size_t len)
+	{
+		__m256i *d = (__m256i *)dst;
+		const __m256i *s = (const __m256i *)src;
+		size_t i;
+
+		for (i = 0; i < len / 32; i++) {
+			RTE_RING_COPY_PREFETCH(s, i, 2);
+			_mm256_storeu_si256(d + i, _mm256_loadu_si256(s + i));
+		}
+		return dst;
+	}
+
+	__attribute__((target("avx2"))) static void *
+		rte_ring_copy_avx2_nt(void *dst, const void *src, size_t len)
+	{
+		__m256i *d = (__m256i *)dst;
+		const __m256i *s = (const __m256i *)src;
+		size_t i;
+
+		for (i = 0; i < len / 32; i++) {
+			RTE_RING_COPY_PREFETCH(s, i, 2);
+			_mm256_stream_si256(d + i, _mm256_loadu_si256(s + i));
+		}
+		_mm_sfence();
+		return dst;
+	}
+
+	__attribute__((target("avx512f"))) static void *
+		rte_ring_copy_avx512(void *dst, const void *src, size_t len)
+	{
+		__m512i *d = (__m512i *)dst;
+		const __m512i *s = (const __m512i *)src;
+		size_t i;
+
+		for (i = 0; i < len / 64; i++) {
+			RTE_RING_COPY_PREFETCH(s, i, 1);
+			_mm512_storeu_si512(d + i, _mm512_loadu_si512(s + i));
+		}
+		return dst;
+	}
+
+	__attribute__((target("avx512f"))) static void *
+		rte_ring_copy_avx512_nt(void *dst, const void *src, size_t len)
+	{
+		__m512i *d = (__m512i *)dst;
+		const __m512i *s = (const __m512i *)src;
+		size_t i;
+
+		for (i = 0; i < len / 64; i++) {
+			RTE_RING_COPY_PREFETCH(s, i, 1);
+			_mm512_stream_si512(d + i, _mm512_loadu_si512(s + i));
+		}
+		_mm_sfence();
+		return dst;
+	}
+
+	/** Elements smaller than this are left to memcpy(). */
+#define RTE_RING_COPY_MIN_SIMD 64
+
+	/**
+	* Pick the copy routine for one direction of a ring.
+	*
+	* @param elemlen
+	*   Size of the element.
+	* @param dst
+	*   Address of the first destination slot, or NULL if the destination
+	*   is not the ring (its alignment is then unknown).
+	* @param nt
+	*   Non-zero to use streaming stores, when the destination allows it.
+	* @return
+	*   The copy routine; memcpy() if no kernel applies.
+	*/
+	static inline rte_ring_copy_t
+		rte_ring_copy_select(uint32_t elemlen, const void *dst, int nt)
+	{
+		const uintptr_t align = (uintptr_t)dst;
+
+		if (elemlen < RTE_RING_COPY_MIN_SIMD)
+			return memcpy;
+		if (dst == NULL)
+			nt = 0;
+
+		__builtin_cpu_init();
+		if (elemlen % 64 == 0 && __builtin_cpu_supports("avx512f")) {
+			if (nt && align % 64 == 0)
+				return rte_ring_copy_avx512_nt;
+			return rte_ring_copy_avx512;
+		}
+		if (elemlen % 32 == 0 && __builtin_cpu_supports("avx2")) {
+			if (nt && align % 32 == 0)
+				return rte_ring_copy_avx2_nt;
+			return rte_ring_copy_avx2;
+		}
+		if (elemlen % 16 == 0) {
+			if (nt && align % 16 == 0)
+				return rte_ring_copy_sse2_nt;
+			return rte_ring_copy_sse2;
+		}
+		return memcpy;
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_COPY_H_ */
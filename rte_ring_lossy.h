@@ -0,0 +1,201 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_LOSSY_H_
+#define _RTE_RING_LOSSY_H_
+
+/**
+* @file
+* RTE Ring lossy mode
+*
+* For telemetry and last-value-wins streams: the producer never waits
+* for the consumer. When the ring is full, new objects overwrite the
+* oldest ones, and the consumer finds out how many it missed:
+*
+*   r = rte_ring_lossy_create(p, len, elemlen, 0);
+*   producer:  rte_ring_lossy_enqueue(r, objs, n);
+*   consumer:  n = rte_ring_lossy_dequeue_burst(r, objs, n, &lost);
+*
+* Each slot has a sequence number, after the ring data, that holds idx + 1
+* once the object of index idx is complete in it. The producer never reads
+* the consumer indexes. The consumer skips ahead when the producer has
+* lapped it, and checks the sequence numbers after copying, seqlock style,
+* to drop objects overwritten while it was reading them. A slow or dead
+* consumer therefore never holds the producer back.
+*
+* The ring has a single producer and a single consumer: producers are
+* never held back by the consumer, so two of them could claim ranges a
+* lap apart and write the same slots. Objects must only be added with
+* rte_ring_lossy_enqueue(), which maintains the sequence numbers.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rte_ring.h"
+
+	/**
+	* Size of the shared memory needed by a lossy ring.
+	*
+	* @param count
+	*   Number of slots of the ring, a power of two
+	* @param elemlen
+	*   size of the element
+	*/
+	static inline size_t
+		rte_ring_lossy_get_memsize(unsigned int count, unsigned int elemlen)
+	{
+		return rte_ring_slot_seq_get_memsize(count, elemlen);
+	}
+
+	/**
+	* Create a new lossy ring in a shared memory. The whole buffer is reset.
+	*
+	* @param p
+	*  A pointer to a shared memory
+	* @param totallen
+	*  size of the shared memory; the number of slots is rounded down to a
+	*  power of two
+	* @param elemlen
+	*  size of the element
+	* @param flags
+	*   Flags of rte_ring_create() other than the sync ones, e.g.
+	*   RING_F_NT_ENQ; RING_F_SP_ENQ, RING_F_SC_DEQ and RING_F_POW2_SZ are
+	*   always added.
+	* @return
+	*   The ring, or NULL on error, e.g. with a multi-producer sync flag.
+	*/
+	static inline struct rte_ring *
+		rte_ring_lossy_create(void *p, size_t totallen, uint32_t elemlen,
+			unsigned int flags)
+	{
+		const uint32_t size = __rte_ring_slot_seq_size(totallen, elemlen);
+
+		if (size == 0)
+			return NULL;
+		return __rte_ring_create(p, totallen, size, elemlen,
+			flags | RING_F_LOSSY | RING_F_SP_ENQ | RING_F_SC_DEQ |
+			RING_F_POW2_SZ, 0);
+	}
+
+	/**
+	* Enqueue objects on a lossy ring, overwriting the oldest ones if the
+	* ring is full. Never fails; if n is above the ring capacity, only the
+	* last objects of obj_table are enqueued, as they would overwrite the
+	* first ones anyway.
+	*
+	* @param r
+	*   A pointer to a ring from rte_ring_lossy_create().
+	* @param obj_table
+	*   A pointer to a table of void * pointers (objects).
+	* @param n
+	*   The number of objects to add in the ring from the obj_table.
+	* @return
+	*   The number of objects enqueued: n, or the capacity if it is smaller.
+	*   They are the last ones of obj_table.
+	*/
+	static __rte_always_inline unsigned int
+		rte_ring_lossy_enqueue(struct rte_ring *r, const void *obj_table,
+			unsigned int n)
+	{
+		const unsigned int is_sp = r->prod_sync_type;
+		rte_ring_idx_t prod_head, prod_next;
+		uint32_t free_entries, i;
+
+		if (unlikely(n > r->capacity)) {
+			obj_table = (const char *)obj_table +
+				(size_t)(n - r->capacity) * r->elemlen;
+			n = r->capacity;
+		}
+		n = __rte_ring_enqueue_start(r, is_sp, n, RTE_RING_QUEUE_VARIABLE,
+			&prod_head, &prod_next, &free_entries);
+		if (n == 0)
+			return 0;
+
+		/* any value but idx + 1 marks the slot as being rewritten */
+		for (i = 0; i < n; i++)
+			__atomic_store_n(&r->seq[(prod_head + i) & r->mask],
+				prod_head + i, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+
+		__rte_ring_enqueue_elems(r, prod_head, obj_table, n);
+
+		for (i = 0; i < n; i++)
+			__atomic_store_n(&r->seq[(prod_head + i) & r->mask],
+				prod_head + i + 1, __ATOMIC_RELEASE);
+
+		__rte_ring_enqueue_finish(r, prod_head, prod_next, is_sp);
+		return n;
+	}
+
+	/**
+	* Dequeue up to n objects from a lossy ring.
+	*
+	* @param r
+	*   A pointer to a ring from rte_ring_lossy_create().
+	* @param obj_table
+	*   A pointer to a table of void * pointers (objects) that will be filled.
+	* @param n
+	*   The maximum number of objects to dequeue.
+	* @param lost
+	*   If non-NULL, returns the number of objects overwritten before this
+	*   call could read them.
+	* @return
+	*   - n: Actual number of objects dequeued; they are consecutive, and
+	*     follow the lost ones.
+	*/
+	static __rte_always_inline unsigned int
+		rte_ring_lossy_dequeue_burst(struct rte_ring *r, void *obj_table,
+			unsigned int n, uint32_t *lost)
+	{
+		const size_t esize = r->elemlen;
+		rte_ring_idx_t cons_head = *r->cons_head;
+		rte_ring_idx_t behind;
+		uint32_t entries, skipped = 0, i;
+
+		behind = __atomic_load_n(r->prod_tail, __ATOMIC_ACQUIRE) - cons_head;
+		entries = (uint32_t)behind;
+		if (unlikely(behind > r->capacity)) {
+			/* lapped: the oldest objects are gone */
+			skipped = (uint32_t)(behind - r->capacity);
+			cons_head += behind - r->capacity;
+			entries = r->capacity;
+		}
+		if (n > entries)
+			n = entries;
+
+		if (n != 0) {
+			__rte_ring_dequeue_elems(r, cons_head, obj_table, n);
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+			/*
+			 * Slots are overwritten oldest first, so keep what follows
+			 * the last one that changed under us.
+			 */
+			for (i = n; i > 0; i--)
+				if (__atomic_load_n(&r->seq[(cons_head + i - 1) & r->mask],
+						__ATOMIC_RELAXED) != cons_head + i)
+					break;
+			if (unlikely(i != 0)) {
+				memmove(obj_table, (char *)obj_table + i * esize,
+					(n - i) * esize);
+				skipped += i;
+				cons_head += i;
+				n -= i;
+			}
+			cons_head += n;
+		}
+
+		__atomic_store_n(r->cons_head, cons_head, __ATOMIC_RELAXED);
+		__atomic_store_n(r->cons_tail, cons_head, __ATOMIC_RELEASE);
+		if (lost != NULL)
+			*lost = skipped;
+		return n;
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_LOSSY_H_ */
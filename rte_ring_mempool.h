@@ -0,0 +1,376 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_MEMPOOL_H_
+#define _RTE_RING_MEMPOOL_H_
+
+/**
+* @file
+* RTE Ring object pool
+*
+* A pool of fixed-size objects in a shared memory, so that large messages
+* can be handed between threads or processes without malloc(): the
+* producer takes a buffer from the pool, fills it and sends its offset
+* through an index ring; the consumer reads it and puts it back.
+*
+*   creator:  mp = rte_ring_mempool_create(p, len, 4096, 2048);
+*   others:   mp = rte_ring_mempool_attach(p);
+*   thread:   c = rte_ring_mempool_cache_create(mp, 32);
+*             buf = rte_ring_mempool_get(mp, c);
+*             rte_ring_enqueue(idx_ring, &(uint32_t){ rte_ring_mempool_off(mp, buf) });
+*   peer:     rte_ring_mempool_put(mp, c, rte_ring_mempool_ptr(mp, off));
+*
+* The free list is a multi-producer/multi-consumer rte_ring of 4-byte
+* offsets from the start of the pool, followed by the objects, each on its
+* own lines, so offsets mean the same thing in every process. A cache per
+* thread keeps recently freed objects and moves them to and from the ring
+* in batches, like the rte_mempool cache. Objects in a cache are only
+* usable by its thread; rte_ring_mempool_cache_free() gives them back.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <errno.h>
+
+#include "rte_ring.h"
+
+#define RTE_RING_MEMPOOL_MAGIC 0x4d455452 /**< "RTEM" */
+
+	/** Pool description at the start of the shared memory. */
+	struct rte_ring_mempool_hdr {
+		uint32_t magic;          /**< RTE_RING_MEMPOOL_MAGIC */
+		uint32_t obj_size;       /**< Object size given at creation */
+		uint32_t obj_stride;     /**< Bytes between two objects */
+		uint32_t obj_count;      /**< Number of objects */
+		uint32_t objs_off;       /**< Offset of the first object */
+		uint32_t init_done;      /**< Non-zero once the pool is usable */
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	/** Process-local handle of a pool. */
+	struct rte_ring_mempool {
+		char *base;              /**< Start of the shared memory */
+		struct rte_ring_mempool_hdr *hdr;
+		struct rte_ring *ring;   /**< Free list of object offsets */
+	};
+
+	/** Per-thread cache of free objects, see rte_ring_mempool_cache_create(). */
+	struct rte_ring_mempool_cache {
+		uint32_t size;           /**< Objects kept after a refill */
+		uint32_t flushthresh;    /**< Objects that trigger a flush */
+		uint32_t len;            /**< Objects in the cache */
+		uint32_t *objs;          /**< 2 * size offsets, after the struct */
+	};
+
+	/** @internal Bytes of free-list ring for count objects. */
+	static inline size_t
+		__rte_ring_mempool_ring_len(unsigned int count)
+	{
+		uint32_t slots = 1;
+
+		while (slots < count)
+			slots <<= 1;
+		return rte_ring_get_memsize(slots, sizeof(uint32_t));
+	}
+
+	/** @internal Offset of the first object. */
+	static inline size_t
+		__rte_ring_mempool_objs_off(unsigned int count)
+	{
+		return (sizeof(struct rte_ring_mempool_hdr) +
+			__rte_ring_mempool_ring_len(count) + RTE_RING_INDEX_PAD - 1) &
+			~(size_t)(RTE_RING_INDEX_PAD - 1);
+	}
+
+	/** @internal Object size rounded up to whole lines. */
+	static inline size_t
+		__rte_ring_mempool_stride(unsigned int obj_size)
+	{
+		return ((size_t)obj_size + RTE_RING_INDEX_PAD - 1) &
+			~(size_t)(RTE_RING_INDEX_PAD - 1);
+	}
+
+	/**
+	* Size of the shared memory needed by a pool.
+	*
+	* @param count
+	*   Number of objects
+	* @param obj_size
+	*   Size of an object
+	*/
+	static inline size_t
+		rte_ring_mempool_get_memsize(unsigned int count, unsigned int obj_size)
+	{
+		return __rte_ring_mempool_objs_off(count) +
+			(size_t)count * __rte_ring_mempool_stride(obj_size);
+	}
+
+	/**
+	* Create a pool of count objects in a shared memory, all of them free.
+	*
+	* @param p
+	*  A pointer to a shared memory, aligned on RTE_RING_INDEX_PAD
+	* @param totallen
+	*  size of the shared memory, at least rte_ring_mempool_get_memsize()
+	*  and at most 4 GB
+	* @param obj_size
+	*  size of an object
+	* @param count
+	*  Number of objects
+	* @return
+	*   The pool, to be freed with rte_ring_mempool_free(), or NULL on error.
+	*/
+	static inline struct rte_ring_mempool *
+		rte_ring_mempool_create(void *p, size_t totallen,
+			unsigned int obj_size, unsigned int count)
+	{
+		const size_t stride = __rte_ring_mempool_stride(obj_size);
+		const size_t ringlen = __rte_ring_mempool_ring_len(count);
+		struct rte_ring_mempool *mp;
+		struct rte_ring_mempool_hdr *hdr = (struct rte_ring_mempool_hdr *)p;
+		uint32_t off[64];
+		unsigned int i, j, n;
+
+		if (obj_size == 0 || count == 0 || totallen > UINT32_MAX ||
+			totallen < rte_ring_mempool_get_memsize(count, obj_size))
+			return NULL;
+		mp = (struct rte_ring_mempool *)malloc(sizeof(*mp));
+		if (mp == NULL)
+			return NULL;
+
+		memset(hdr, 0, sizeof(*hdr));
+		mp->base = (char *)p;
+		mp->hdr = hdr;
+		mp->ring = rte_ring_create(mp->base + sizeof(*hdr), (int)ringlen,
+			sizeof(uint32_t), RING_F_POW2_SZ);
+		if (mp->ring == NULL) {
+			free(mp);
+			return NULL;
+		}
+		hdr->magic = RTE_RING_MEMPOOL_MAGIC;
+		hdr->obj_size = obj_size;
+		hdr->obj_stride = (uint32_t)stride;
+		hdr->obj_count = count;
+		hdr->objs_off = (uint32_t)__rte_ring_mempool_objs_off(count);
+
+		for (i = 0; i < count; i += n) {
+			n = count - i < 64 ? count - i : 64;
+			for (j = 0; j < n; j++)
+				off[j] = hdr->objs_off + (i + j) * hdr->obj_stride;
+			rte_ring_enqueue_bulk(mp->ring, off, n, NULL);
+		}
+		__atomic_store_n(&hdr->init_done, 1, __ATOMIC_RELEASE);
+		return mp;
+	}
+
+	/**
+	* Map an existing pool, created by rte_ring_mempool_create() possibly in
+	* another process.
+	*
+	* @param p
+	*  A pointer to the shared memory holding the pool
+	* @return
+	*   The pool, or NULL if p does not hold an initialized pool.
+	*/
+	static inline struct rte_ring_mempool *
+		rte_ring_mempool_attach(void *p)
+	{
+		struct rte_ring_mempool_hdr *hdr = (struct rte_ring_mempool_hdr *)p;
+		struct rte_ring_mempool *mp;
+
+		if (__atomic_load_n(&hdr->init_done, __ATOMIC_ACQUIRE) == 0 ||
+			hdr->magic != RTE_RING_MEMPOOL_MAGIC)
+			return NULL;
+		mp = (struct rte_ring_mempool *)malloc(sizeof(*mp));
+		if (mp == NULL)
+			return NULL;
+		mp->base = (char *)p;
+		mp->hdr = hdr;
+		mp->ring = rte_ring_attach(mp->base + sizeof(*hdr));
+		if (mp->ring == NULL) {
+			free(mp);
+			return NULL;
+		}
+		return mp;
+	}
+
+	/**
+	* Free the process-local handle of a pool. The shared memory is left
+	* untouched.
+	*/
+	static inline void
+		rte_ring_mempool_free(struct rte_ring_mempool *mp)
+	{
+		rte_ring_free(mp->ring);
+		free(mp);
+	}
+
+	/** Address of the object at offset off. */
+	static __rte_always_inline void *
+		rte_ring_mempool_ptr(const struct rte_ring_mempool *mp, uint32_t off)
+	{
+		return mp->base + off;
+	}
+
+	/** Offset of an object, valid in every process mapping the pool. */
+	static __rte_always_inline uint32_t
+		rte_ring_mempool_off(const struct rte_ring_mempool *mp, const void *obj)
+	{
+		return (uint32_t)((const char *)obj - mp->base);
+	}
+
+	/**
+	* Number of free objects in the ring, not counting the caches.
+	*/
+	static inline unsigned int
+		rte_ring_mempool_avail_count(const struct rte_ring_mempool *mp)
+	{
+		struct rte_ring_info info;
+
+		rte_ring_get_info(mp->ring, &info);
+		return info.count;
+	}
+
+	/**
+	* Create a cache of free objects for the calling thread.
+	*
+	* @param mp
+	*   A pool.
+	* @param size
+	*   Objects moved from the ring at once, at most the pool size.
+	* @return
+	*   The cache, or NULL on error.
+	*/
+	static inline struct rte_ring_mempool_cache *
+		rte_ring_mempool_cache_create(struct rte_ring_mempool *mp,
+			unsigned int size)
+	{
+		struct rte_ring_mempool_cache *c;
+
+		if (size == 0 || size > mp->hdr->obj_count)
+			return NULL;
+		c = (struct rte_ring_mempool_cache *)malloc(sizeof(*c) +
+			2 * (size_t)size * sizeof(uint32_t));
+		if (c == NULL)
+			return NULL;
+		c->size = size;
+		c->flushthresh = size + size / 2;
+		c->len = 0;
+		c->objs = (uint32_t *)(c + 1);
+		return c;
+	}
+
+	/**
+	* Put back n objects, given by offset.
+	*
+	* @param mp
+	*   A pool.
+	* @param c
+	*   The calling thread's cache, or NULL to use the ring directly.
+	* @param offs
+	*   Offsets of the objects.
+	* @param n
+	*   Number of objects.
+	*/
+	static inline void
+		rte_ring_mempool_put_bulk(struct rte_ring_mempool *mp,
+			struct rte_ring_mempool_cache *c, const uint32_t *offs,
+			unsigned int n)
+	{
+		unsigned int i;
+
+		/* the ring can hold all objects, so these never fail */
+		if (c == NULL || n > c->size) {
+			rte_ring_enqueue_bulk(mp->ring, (void *)offs, n, NULL);
+			return;
+		}
+		if (c->len + n > c->flushthresh) {
+			rte_ring_enqueue_bulk(mp->ring, c->objs, c->len, NULL);
+			c->len = 0;
+		}
+		for (i = 0; i < n; i++)
+			c->objs[c->len++] = offs[i];
+	}
+
+	/**
+	* Take n objects, given by offset.
+	*
+	* @param mp
+	*   A pool.
+	* @param c
+	*   The calling thread's cache, or NULL to use the ring directly.
+	* @param offs
+	*   Filled with the offsets of the objects.
+	* @param n
+	*   Number of objects.
+	* @return
+	*   0, or -ENOENT if there are not n free objects; none are taken then.
+	*/
+	static inline int
+		rte_ring_mempool_get_bulk(struct rte_ring_mempool *mp,
+			struct rte_ring_mempool_cache *c, uint32_t *offs, unsigned int n)
+	{
+		unsigned int i;
+
+		if (c == NULL || n > c->size)
+			return rte_ring_dequeue_bulk(mp->ring, offs, n, NULL) == n ?
+				0 : -ENOENT;
+		if (c->len < n) {
+			/* refill, so that size objects remain after this get */
+			c->len += rte_ring_dequeue_burst(mp->ring, &c->objs[c->len],
+				c->size + n - c->len, NULL);
+			if (unlikely(c->len < n))
+				return -ENOENT;
+		}
+		/* most recently freed first, it is likely still in cache */
+		for (i = 0; i < n; i++)
+			offs[i] = c->objs[--c->len];
+		return 0;
+	}
+
+	/**
+	* Take one object.
+	*
+	* @return
+	*   The object, or NULL if the pool is empty.
+	*/
+	static inline void *
+		rte_ring_mempool_get(struct rte_ring_mempool *mp,
+			struct rte_ring_mempool_cache *c)
+	{
+		uint32_t off;
+
+		if (rte_ring_mempool_get_bulk(mp, c, &off, 1) != 0)
+			return NULL;
+		return rte_ring_mempool_ptr(mp, off);
+	}
+
+	/**
+	* Put back one object, which may come from another process.
+	*/
+	static inline void
+		rte_ring_mempool_put(struct rte_ring_mempool *mp,
+			struct rte_ring_mempool_cache *c, void *obj)
+	{
+		const uint32_t off = rte_ring_mempool_off(mp, obj);
+
+		rte_ring_mempool_put_bulk(mp, c, &off, 1);
+	}
+
+	/**
+	* Give the objects of a cache back to the ring and free it.
+	*/
+	static inline void
+		rte_ring_mempool_cache_free(struct rte_ring_mempool *mp,
+			struct rte_ring_mempool_cache *c)
+	{
+		rte_ring_enqueue_bulk(mp->ring, c->objs, c->len, NULL);
+		free(c);
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_MEMPOOL_H_ */
@@ -0,0 +1,267 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_MESH_H_
+#define _RTE_RING_MESH_H_
+
+/**
+* @file
+* RTE Ring per-socket mesh
+*
+* One ring per (producer node, consumer node) pair, each in its own named
+* shared memory "<prefix>.<prod>.<cons>" placed with
+* rte_ring_create_shm_numa(), so that only the traffic that has to cross
+* sockets does:
+*
+*   creator:   m = rte_ring_mesh_create("/feed", 0, 4096, 64, 0);
+*   others:    m = rte_ring_mesh_attach("/feed", 0);
+*   producer:  rte_ring_enqueue_burst(rte_ring_mesh_get(m, me, dst), ...);
+*   consumer:  n = rte_ring_mesh_dequeue_burst(m, me, objs, 32, &from);
+*   all:       rte_ring_mesh_free(m);
+*   last one:  rte_ring_mesh_unlink("/feed", m->nsockets);
+*
+* The node of the calling thread is given by rte_ring_socket_id(); threads
+* should be pinned for it to stay right.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rte_ring_shm.h"
+
+#ifndef RTE_RING_MESH_MAX_SOCKETS
+#define RTE_RING_MESH_MAX_SOCKETS 8 /**< NUMA nodes in a mesh */
+#endif
+
+	/** Rings between the NUMA nodes of a machine. */
+	struct rte_ring_mesh {
+		unsigned int nsockets;   /**< Number of nodes */
+		/** Ring from node p to node c is rings[p][c] */
+		struct rte_ring *rings[RTE_RING_MESH_MAX_SOCKETS][RTE_RING_MESH_MAX_SOCKETS];
+	};
+
+	/**
+	* Number of NUMA nodes of the machine, from sysfs.
+	*
+	* @return
+	*   The highest online node plus one, 1 without NUMA.
+	*/
+	static inline unsigned int
+		rte_ring_socket_count(void)
+	{
+		char buf[256], *s;
+		unsigned int n = 1;
+		FILE *f;
+
+		f = fopen("/sys/devices/system/node/online", "r");
+		if (f == NULL)
+			return 1;
+		if (fgets(buf, sizeof(buf), f) != NULL) {
+			/* a list like "0-1,3": the last number is the highest node */
+			s = buf + strcspn(buf, "\n");
+			while (s > buf && (s[-1] >= '0' && s[-1] <= '9'))
+				s--;
+			n = (unsigned int)atoi(s) + 1;
+		}
+		fclose(f);
+		return n;
+	}
+
+	/** @internal Name of the ring from node p to node c. */
+	static inline void
+		__rte_ring_mesh_name(char *name, size_t len, const char *prefix,
+			unsigned int p, unsigned int c)
+	{
+		snprintf(name, len, "%s.%u.%u", prefix, p, c);
+	}
+
+	/**
+	* Remove the shared memories of a mesh; see rte_ring_unlink_shm().
+	*/
+	static inline void
+		rte_ring_mesh_unlink(const char *prefix, unsigned int nsockets)
+	{
+		char name[NAME_MAX];
+		unsigned int p, c;
+
+		for (p = 0; p < nsockets; p++)
+			for (c = 0; c < nsockets; c++) {
+				__rte_ring_mesh_name(name, sizeof(name), prefix, p, c);
+				rte_ring_unlink_shm(name);
+			}
+	}
+
+	/**
+	* Unmap the rings of a mesh and free it.
+	*/
+	static inline void
+		rte_ring_mesh_free(struct rte_ring_mesh *m)
+	{
+		unsigned int p, c;
+
+		for (p = 0; p < m->nsockets; p++)
+			for (c = 0; c < m->nsockets; c++)
+				if (m->rings[p][c] != NULL)
+					rte_ring_free_shm(m->rings[p][c]);
+		free(m);
+	}
+
+	/**
+	* Create the nsockets * nsockets rings of a mesh. Ring (p, c) has its
+	* data on node c and its header, consumer head and tail included, on
+	* node p.
+	*
+	* @param prefix
+	*   Prefix of the shared memory names.
+	* @param nsockets
+	*   Number of NUMA nodes, or 0 for rte_ring_socket_count().
+	* @param count
+	*   Number of slots of each ring.
+	* @param elemlen
+	*   size of the element
+	* @param flags
+	*   Flags of rte_ring_create_shm().
+	* @return
+	*   The mesh, or NULL with errno set on error; the rings created so far
+	*   are then unlinked.
+	*/
+	static inline struct rte_ring_mesh *
+		rte_ring_mesh_create(const char *prefix, unsigned int nsockets,
+			unsigned int count, unsigned int elemlen, unsigned int flags)
+	{
+		char name[NAME_MAX];
+		struct rte_ring_mesh *m;
+		unsigned int p, c;
+		int err;
+
+		if (nsockets == 0)
+			nsockets = rte_ring_socket_count();
+		if (nsockets > RTE_RING_MESH_MAX_SOCKETS) {
+			errno = EINVAL;
+			return NULL;
+		}
+		m = (struct rte_ring_mesh *)calloc(1, sizeof(*m));
+		if (m == NULL)
+			return NULL;
+		m->nsockets = nsockets;
+
+		for (p = 0; p < nsockets; p++)
+			for (c = 0; c < nsockets; c++) {
+				__rte_ring_mesh_name(name, sizeof(name), prefix, p, c);
+				m->rings[p][c] = rte_ring_create_shm_numa(name, count,
+					elemlen, nsockets == 1 ? SOCKET_ID_ANY : (int)p,
+					nsockets == 1 ? SOCKET_ID_ANY : (int)c, flags);
+				if (m->rings[p][c] == NULL)
+					goto fail;
+			}
+		return m;
+
+	fail:
+		err = errno;
+		for (p = 0; p < nsockets; p++)
+			for (c = 0; c < nsockets; c++)
+				if (m->rings[p][c] != NULL) {
+					__rte_ring_mesh_name(name, sizeof(name), prefix, p, c);
+					rte_ring_unlink_shm(name);
+				}
+		rte_ring_mesh_free(m);
+		errno = err;
+		return NULL;
+	}
+
+	/**
+	* Map the rings of a mesh created by rte_ring_mesh_create().
+	*
+	* @param nsockets
+	*   Number of NUMA nodes the mesh was created with, or 0 for
+	*   rte_ring_socket_count().
+	* @return
+	*   The mesh, or NULL with errno set on error.
+	*/
+	static inline struct rte_ring_mesh *
+		rte_ring_mesh_attach(const char *prefix, unsigned int nsockets)
+	{
+		char name[NAME_MAX];
+		struct rte_ring_mesh *m;
+		unsigned int p, c;
+		int err;
+
+		if (nsockets == 0)
+			nsockets = rte_ring_socket_count();
+		if (nsockets > RTE_RING_MESH_MAX_SOCKETS) {
+			errno = EINVAL;
+			return NULL;
+		}
+		m = (struct rte_ring_mesh *)calloc(1, sizeof(*m));
+		if (m == NULL)
+			return NULL;
+		m->nsockets = nsockets;
+
+		for (p = 0; p < nsockets; p++)
+			for (c = 0; c < nsockets; c++) {
+				__rte_ring_mesh_name(name, sizeof(name), prefix, p, c);
+				m->rings[p][c] = rte_ring_attach_shm(name);
+				if (m->rings[p][c] == NULL) {
+					err = errno;
+					rte_ring_mesh_free(m);
+					errno = err;
+					return NULL;
+				}
+			}
+		return m;
+	}
+
+	/**
+	* Ring from producer node prod to consumer node cons. For a producer
+	* thread, prod is usually rte_ring_socket_id().
+	*/
+	static inline struct rte_ring *
+		rte_ring_mesh_get(const struct rte_ring_mesh *m, unsigned int prod,
+			unsigned int cons)
+	{
+		return m->rings[prod][cons];
+	}
+
+	/**
+	* Dequeue up to n objects bound for node cons, from the ring of the
+	* local node first, then from the remote ones in node order.
+	*
+	* @param m
+	*   A mesh.
+	* @param cons
+	*   NUMA node of the consumer.
+	* @param obj_table
+	*   A pointer to a table of objects that will be filled.
+	* @param n
+	*   The maximum number of objects to dequeue.
+	* @param from
+	*   If non-NULL, returns the producer node the objects come from.
+	* @return
+	*   - n: Actual number of objects dequeued, all from one ring.
+	*/
+	static inline unsigned int
+		rte_ring_mesh_dequeue_burst(const struct rte_ring_mesh *m,
+			unsigned int cons, void *obj_table, unsigned int n,
+			unsigned int *from)
+	{
+		unsigned int i, p, ret;
+
+		for (i = 0; i < m->nsockets; i++) {
+			p = (cons + i) % m->nsockets;
+			ret = rte_ring_dequeue_burst(m->rings[p][cons], obj_table, n,
+				NULL);
+			if (ret != 0) {
+				if (from != NULL)
+					*from = p;
+				return ret;
+			}
+		}
+		return 0;
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_MESH_H_ */
@@ -0,0 +1,245 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_MSG_H_
+#define _RTE_RING_MSG_H_
+
+/**
+* @file
+* RTE Ring variable-length messages
+*
+* Stores length-prefixed records of any size in the data area of a ring,
+* instead of one fixed-size object per slot:
+*
+*   r = rte_ring_msg_create(p, totallen, 0);
+*
+*   buf = rte_ring_msg_reserve(r, 1500);
+*   ... write up to 1500 bytes at buf ...
+*   rte_ring_msg_commit(r, len);
+*
+*   buf = rte_ring_msg_peek(r, &len);
+*   ... read len bytes at buf ...
+*   rte_ring_msg_release(r);
+*
+* The ring slots are RTE_RING_MSG_ALIGN bytes. A record is one slot of
+* struct rte_ring_msg_hdr followed by the payload rounded up to whole
+* slots, so payloads are always contiguous and 8-byte aligned. When a
+* record does not fit before the end of the data area, a skip marker fills
+* the rest and the record starts at slot 0.
+*
+* Messages have one producer and one consumer (the ring is created with
+* RING_F_SP_ENQ and RING_F_SC_DEQ), which may be in different processes.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rte_ring.h"
+
+/** Size of a slot of a message ring, and alignment of the payloads. */
+#define RTE_RING_MSG_ALIGN 8
+/** Length value of a skip marker. */
+#define RTE_RING_MSG_SKIP UINT32_MAX
+
+	/** Record header, in the slot before the payload. */
+	struct rte_ring_msg_hdr {
+		uint32_t len;            /**< Payload bytes, or RTE_RING_MSG_SKIP */
+		uint32_t reserved;
+	};
+
+	/**
+	 * @internal Slots taken by a record of len bytes, header included.
+	 */
+	static __rte_always_inline uint32_t
+		__rte_ring_msg_slots(uint32_t len)
+	{
+		return 1 + (len + RTE_RING_MSG_ALIGN - 1) / RTE_RING_MSG_ALIGN;
+	}
+
+	static __rte_always_inline struct rte_ring_msg_hdr *
+		__rte_ring_msg_hdr(struct rte_ring *r, uint32_t slot)
+	{
+		return (struct rte_ring_msg_hdr *)r->data + slot;
+	}
+
+	/**
+	 * @internal Find the record starting at index pos, after a skip
+	 * marker if there is one.
+	 *
+	 * @param skip
+	 *   Returns the slots taken by the skip marker, 0 if there is none.
+	 * @return
+	 *   The header of the record.
+	 */
+	static __rte_always_inline struct rte_ring_msg_hdr *
+		__rte_ring_msg_find(struct rte_ring *r, rte_ring_idx_t pos,
+			uint32_t *skip)
+	{
+		const uint32_t idx = (uint32_t)(pos & r->mask);
+		struct rte_ring_msg_hdr *h = __rte_ring_msg_hdr(r, idx);
+
+		if (h->len == RTE_RING_MSG_SKIP) {
+			*skip = r->size - idx;
+			return __rte_ring_msg_hdr(r, 0);
+		}
+		*skip = 0;
+		return h;
+	}
+
+	/**
+	* Create a new message ring in a shared memory. The whole buffer is
+	* reset.
+	*
+	* @param p
+	*  A pointer to a shared memory
+	* @param totallen
+	*  size of the shared memory; the data area, totallen minus
+	*  RTE_RING_HDR_SIZE, is rounded down to a power of two
+	* @param flags
+	*   RING_F_WAIT, see rte_ring_create().
+	* @return
+	*   The ring, or NULL on error.
+	*/
+	static inline struct rte_ring *
+		rte_ring_msg_create(void *p, int totallen, unsigned int flags)
+	{
+		return rte_ring_create(p, totallen, RTE_RING_MSG_ALIGN,
+			flags | RING_F_MSG | RING_F_POW2_SZ |
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	}
+
+	/**
+	* Largest payload that always fits in an empty message ring, whatever
+	* the position of the indexes.
+	*/
+	static inline uint32_t
+		rte_ring_msg_max_len(const struct rte_ring *r)
+	{
+		return (r->size / 2 - 1) * RTE_RING_MSG_ALIGN;
+	}
+
+	/**
+	* Reserve room for a message of up to len bytes, to be written in
+	* place.
+	*
+	* @param r
+	*   A pointer to a ring from rte_ring_msg_create().
+	* @param len
+	*   The largest payload the caller will write.
+	* @return
+	*   Where to write the payload, or NULL if there is not enough room.
+	*/
+	static inline void *
+		rte_ring_msg_reserve(struct rte_ring *r, uint32_t len)
+	{
+		const uint32_t slots = __rte_ring_msg_slots(len);
+		uint32_t idx = (uint32_t)(*r->prod_head & r->mask);
+		uint32_t pad = 0;
+		rte_ring_idx_t prod_head, prod_next;
+		uint32_t free_entries;
+		struct rte_ring_msg_hdr *h;
+
+		if (unlikely(len > rte_ring_msg_max_len(r)))
+			return NULL;
+		if (idx + slots > r->size)
+			pad = r->size - idx;
+
+		if (__rte_ring_enqueue_start(r, RTE_RING_SYNC_ST, pad + slots,
+				RTE_RING_QUEUE_FIXED, &prod_head, &prod_next,
+				&free_entries) == 0)
+			return NULL;
+
+		/* commit finds the record from these headers */
+		h = __rte_ring_msg_hdr(r, idx);
+		if (pad != 0) {
+			h->len = RTE_RING_MSG_SKIP;
+			h = __rte_ring_msg_hdr(r, 0);
+		}
+		h->len = 0;
+		return h + 1;
+	}
+
+	/**
+	* Publish the message written into a buffer from rte_ring_msg_reserve().
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	* @param len
+	*   The payload length, at most the reserved length. Reserved room
+	*   beyond it is given back.
+	*/
+	static inline void
+		rte_ring_msg_commit(struct rte_ring *r, uint32_t len)
+	{
+		const rte_ring_idx_t prod_tail = *r->prod_tail;
+		struct rte_ring_msg_hdr *h;
+		rte_ring_idx_t prod_next;
+		uint32_t skip;
+
+		h = __rte_ring_msg_find(r, prod_tail, &skip);
+		h->len = len;
+		prod_next = prod_tail + skip + __rte_ring_msg_slots(len);
+
+		__atomic_store_n(r->prod_head, prod_next, __ATOMIC_RELAXED);
+		__rte_ring_enqueue_finish(r, prod_tail, prod_next, RTE_RING_SYNC_ST);
+	}
+
+	/**
+	* Get the next message, to be read in place.
+	*
+	* @param r
+	*   A pointer to a ring from rte_ring_msg_create().
+	* @param len
+	*   Returns the payload length.
+	* @return
+	*   The payload, or NULL if the ring is empty. It stays valid until
+	*   rte_ring_msg_release().
+	*/
+	static inline const void *
+		rte_ring_msg_peek(struct rte_ring *r, uint32_t *len)
+	{
+		rte_ring_idx_t cons_head, cons_next;
+		uint32_t entries, skip;
+		struct rte_ring_msg_hdr *h;
+
+		if (__rte_ring_dequeue_start(r, RTE_RING_SYNC_ST, 1,
+				RTE_RING_QUEUE_FIXED, &cons_head, &cons_next,
+				&entries) == 0)
+			return NULL;
+
+		/* the whole record was published by a single tail update */
+		h = __rte_ring_msg_find(r, cons_head, &skip);
+		cons_next = cons_head + skip + __rte_ring_msg_slots(h->len);
+		__atomic_store_n(r->cons_head, cons_next, __ATOMIC_RELAXED);
+		r->cons_shadow.head = cons_next;
+		*len = h->len;
+		return h + 1;
+	}
+
+	/**
+	* Give back the room of the message returned by rte_ring_msg_peek().
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	*/
+	static inline void
+		rte_ring_msg_release(struct rte_ring *r)
+	{
+		const rte_ring_idx_t cons_tail = *r->cons_tail;
+		struct rte_ring_msg_hdr *h;
+		rte_ring_idx_t cons_next;
+		uint32_t skip;
+
+		h = __rte_ring_msg_find(r, cons_tail, &skip);
+		cons_next = cons_tail + skip + __rte_ring_msg_slots(h->len);
+
+		__atomic_store_n(r->cons_head, cons_next, __ATOMIC_RELAXED);
+		__rte_ring_dequeue_finish(r, cons_tail, cons_next, RTE_RING_SYNC_ST);
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_MSG_H_ */
@@ -0,0 +1,232 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_PEEK_ZC_H_
+#define _RTE_RING_PEEK_ZC_H_
+
+/**
+* @file
+* RTE Ring zero-copy API
+*
+* Lets the producer build objects in place in the ring and the consumer
+* read them in place, instead of copying through an object table:
+*
+*   struct rte_ring_zc_data zcd;
+*   n = rte_ring_enqueue_reserve(r, n, &zcd);
+*   ... write zcd.n1 objects at zcd.ptr1, n - zcd.n1 objects at zcd.ptr2 ...
+*   rte_ring_enqueue_commit(r, n);
+*
+*   n = rte_ring_dequeue_peek(r, n, &zcd);
+*   ... read the objects ...
+*   rte_ring_dequeue_release(r, n);
+*
+* Between the two calls the reserved slots belong to the caller. Because
+* commit/release only get a count, the enqueue side needs a
+* single-producer ring (RING_F_SP_ENQ) or a head/tail sync one
+* (RING_F_MP_HTS_ENQ), where a single producer at a time holds slots, and
+* likewise RING_F_SC_DEQ or RING_F_MC_HTS_DEQ for the dequeue side; on other
+* rings reserve and peek return 0.
+*
+* rte_ring_drain() instead runs a callback on claimed objects in place and
+* releases them before returning, which works with any consumer mode.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rte_ring.h"
+
+	/**
+	 * Reserved slots. When the reservation wraps around the end of the
+	 * ring, the first n1 objects are at ptr1 and the rest at ptr2;
+	 * otherwise everything is at ptr1 and ptr2 is NULL.
+	 */
+	struct rte_ring_zc_data {
+		void *ptr1;              /**< First span of objects */
+		void *ptr2;              /**< Second span, from the start of r->data */
+		unsigned int n1;         /**< Number of objects in the first span */
+	};
+
+	/**
+	 * @internal Describe n slots starting at head value head.
+	 */
+	static __rte_always_inline void
+		__rte_ring_get_zc_spans(struct rte_ring *r, rte_ring_idx_t head,
+			unsigned int n, struct rte_ring_zc_data *zcd)
+	{
+		const uint32_t idx = __rte_ring_slot(r, head);
+		const uint32_t first = r->size - idx;
+
+		zcd->ptr1 = (char *)r->data + (size_t)idx * r->elemlen;
+		if (likely(n <= first)) {
+			zcd->n1 = n;
+			zcd->ptr2 = NULL;
+		} else {
+			zcd->n1 = first;
+			zcd->ptr2 = r->data;
+		}
+	}
+
+	/**
+	 * Reserve room for n objects to be written in place.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure, created with RING_F_SP_ENQ or
+	 *   RING_F_MP_HTS_ENQ.
+	 * @param n
+	 *   The number of objects to reserve.
+	 * @param zcd
+	 *   Filled with the location of the reserved slots.
+	 * @return
+	 *   The number of objects reserved, either 0 or n
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_enqueue_reserve(struct rte_ring *r, unsigned int n,
+			struct rte_ring_zc_data *zcd)
+	{
+		rte_ring_idx_t prod_head, prod_next;
+		uint32_t free_entries;
+
+		if (unlikely((r->prod_sync_type != RTE_RING_SYNC_ST &&
+				r->prod_sync_type != RTE_RING_SYNC_MT_HTS) ||
+				(r->flags & RING_F_SLOT_SEQ)))
+			return 0;
+
+		n = __rte_ring_enqueue_start(r, r->prod_sync_type, n,
+			RTE_RING_QUEUE_FIXED, &prod_head, &prod_next, &free_entries);
+		if (n != 0)
+			__rte_ring_get_zc_spans(r, prod_head, n, zcd);
+		return n;
+	}
+
+	/**
+	 * Publish objects written into slots from rte_ring_enqueue_reserve().
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param n
+	 *   The number of objects to publish, at most the number reserved.
+	 *   Reserved slots beyond n are given back.
+	 */
+	static __rte_always_inline void
+		rte_ring_enqueue_commit(struct rte_ring *r, unsigned int n)
+	{
+		const rte_ring_idx_t prod_tail = *r->prod_tail;
+		const rte_ring_idx_t prod_next = __rte_ring_wrap(r, prod_tail + n);
+
+		__atomic_store_n(r->prod_head, prod_next, __ATOMIC_RELAXED);
+		__rte_ring_enqueue_finish(r, prod_tail, prod_next,
+			r->prod_sync_type);
+	}
+
+	/**
+	 * Get n objects to be read in place.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure, created with RING_F_SC_DEQ or
+	 *   RING_F_MC_HTS_DEQ.
+	 * @param n
+	 *   The number of objects to get.
+	 * @param zcd
+	 *   Filled with the location of the objects.
+	 * @return
+	 *   The number of objects available, either 0 or n
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_dequeue_peek(struct rte_ring *r, unsigned int n,
+			struct rte_ring_zc_data *zcd)
+	{
+		rte_ring_idx_t cons_head, cons_next;
+		uint32_t entries;
+
+		if (unlikely((r->cons_sync_type != RTE_RING_SYNC_ST &&
+				r->cons_sync_type != RTE_RING_SYNC_MT_HTS) ||
+				(r->flags & RING_F_SLOT_SEQ)))
+			return 0;
+
+		n = __rte_ring_dequeue_start(r, r->cons_sync_type, n,
+			RTE_RING_QUEUE_FIXED, &cons_head, &cons_next, &entries);
+		if (n != 0)
+			__rte_ring_get_zc_spans(r, cons_head, n, zcd);
+		return n;
+	}
+
+	/**
+	 * Give back slots read through rte_ring_dequeue_peek().
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param n
+	 *   The number of objects consumed, at most the number peeked.
+	 *   Objects beyond n stay in the ring.
+	 */
+	static __rte_always_inline void
+		rte_ring_dequeue_release(struct rte_ring *r, unsigned int n)
+	{
+		const rte_ring_idx_t cons_tail = *r->cons_tail;
+		const rte_ring_idx_t cons_next = __rte_ring_wrap(r, cons_tail + n);
+
+		__atomic_store_n(r->cons_head, cons_next, __ATOMIC_RELAXED);
+		__rte_ring_dequeue_finish(r, cons_tail, cons_next,
+			r->cons_sync_type);
+	}
+
+	/**
+	 * Called by rte_ring_drain() on n objects in place in the ring.
+	 */
+	typedef void (*rte_ring_drain_cb_t)(void *ctx, void *objs,
+		unsigned int n);
+
+	/**
+	 * Dequeue up to max objects, handing them to a callback in place.
+	 *
+	 * All objects are claimed with one head move and released with one
+	 * tail update, after the callback has been run on each contiguous
+	 * span (at most two). Unlike rte_ring_dequeue_peek() this works with
+	 * any consumer mode, but not with RING_F_SLOT_SEQ.
+	 *
+	 * @param r
+	 *   A pointer to the ring structure.
+	 * @param max
+	 *   The most objects to dequeue.
+	 * @param cb
+	 *   Run on each span of objects; they must not be used after it
+	 *   returns.
+	 * @param ctx
+	 *   Passed to cb.
+	 * @return
+	 *   The number of objects dequeued.
+	 */
+	static __rte_always_inline unsigned int
+		rte_ring_drain(struct rte_ring *r, unsigned int max,
+			rte_ring_drain_cb_t cb, void *ctx)
+	{
+		const unsigned int is_sc = r->cons_sync_type;
+		struct rte_ring_zc_data zcd;
+		rte_ring_idx_t cons_head, cons_next;
+		uint32_t entries;
+		unsigned int n;
+
+		if (unlikely(r->flags & RING_F_SLOT_SEQ))
+			return 0;
+
+		n = __rte_ring_dequeue_start(r, is_sc, max, RTE_RING_QUEUE_VARIABLE,
+			&cons_head, &cons_next, &entries);
+		if (n == 0)
+			return 0;
+
+		__rte_ring_get_zc_spans(r, cons_head, n, &zcd);
+		cb(ctx, zcd.ptr1, zcd.n1);
+		if (zcd.ptr2 != NULL)
+			cb(ctx, zcd.ptr2, n - zcd.n1);
+
+		__rte_ring_dequeue_finish(r, cons_head, cons_next, is_sc);
+		return n;
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_PEEK_ZC_H_ */
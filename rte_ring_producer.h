@@ -0,0 +1,176 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_PRODUCER_H_
+#define _RTE_RING_PRODUCER_H_
+
+/**
+* @file
+* RTE Ring producer staging
+*
+* Producers that emit one small object at a time pay a head move and a
+* tail publish on shared lines for each of them. A staging buffer owned by
+* one thread collects the objects and hands them over with a single
+* enqueue once it holds threshold of them, once the oldest has waited
+* max_delay_ns, or on rte_ring_producer_flush():
+*
+*   static __thread struct rte_ring_producer *stage;
+*
+*   stage = rte_ring_producer_create(r, 32, 50000);
+*   rte_ring_producer_enqueue(stage, &ev);      for each event
+*   rte_ring_producer_flush(stage);             before going idle
+*
+* The clock is read once per batch, when its first object is staged, and
+* the deadline is checked every RTE_RING_PRODUCER_CHECK objects after it
+* and on each rte_ring_producer_poll(). A slow stream can thus hold
+* objects a little past max_delay_ns, and an idle loop should call
+* rte_ring_producer_poll(). Staged objects are not visible to
+* consumers, and are counted neither by the ring nor by its statistics.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rte_ring.h"
+
+#ifndef RTE_RING_PRODUCER_CHECK
+/** Staged objects between deadline checks, a power of two */
+#define RTE_RING_PRODUCER_CHECK 8
+#endif
+
+	/** Staging buffer of one producer thread, see rte_ring_producer_create(). */
+	struct rte_ring_producer {
+		struct rte_ring *r;      /**< Ring the objects go to */
+		uint32_t count;          /**< Objects staged */
+		uint32_t threshold;      /**< Flush once this many are staged */
+		uint64_t max_delay_ns;   /**< Flush once the oldest is this old */
+		uint64_t oldest_ns;      /**< When the oldest was staged */
+		char *buf;               /**< threshold objects, after the struct */
+	};
+
+	/**
+	* Create a staging buffer for a producer thread of r.
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	* @param threshold
+	*   Objects staged before they are flushed, at most the ring capacity.
+	* @param max_delay_ns
+	*   Longest an object stays staged, or 0 to only flush on threshold
+	*   and on explicit flushes.
+	* @return
+	*   The buffer, to be freed with rte_ring_producer_free(), or NULL on
+	*   error.
+	*/
+	static inline struct rte_ring_producer *
+		rte_ring_producer_create(struct rte_ring *r, unsigned int threshold,
+			uint64_t max_delay_ns)
+	{
+		struct rte_ring_producer *p;
+
+		if (threshold == 0 || threshold > r->capacity)
+			return NULL;
+		p = (struct rte_ring_producer *)malloc(sizeof(*p) +
+			(size_t)threshold * r->elemlen);
+		if (p == NULL)
+			return NULL;
+		p->r = r;
+		p->count = 0;
+		p->threshold = threshold;
+		p->max_delay_ns = max_delay_ns;
+		p->oldest_ns = 0;
+		p->buf = (char *)(p + 1);
+		return p;
+	}
+
+	/**
+	* Enqueue all staged objects that fit in the ring, with one head
+	* move. The ones that do not fit stay staged, in order.
+	*
+	* @param p
+	*   A staging buffer.
+	* @return
+	*   The number of objects still staged, 0 once everything was enqueued.
+	*/
+	static inline unsigned int
+		rte_ring_producer_flush(struct rte_ring_producer *p)
+	{
+		const size_t esize = p->r->elemlen;
+		unsigned int n;
+
+		if (p->count == 0)
+			return 0;
+		n = rte_ring_enqueue_burst(p->r, p->buf, p->count, NULL);
+		p->count -= n;
+		if (unlikely(p->count != 0 && n != 0))
+			memmove(p->buf, p->buf + n * esize, p->count * esize);
+		return p->count;
+	}
+
+	/**
+	* Flush if the oldest staged object has waited its maximum delay.
+	*
+	* @param p
+	*   A staging buffer.
+	* @return
+	*   The number of objects still staged.
+	*/
+	static inline unsigned int
+		rte_ring_producer_poll(struct rte_ring_producer *p)
+	{
+		if (p->count != 0 && p->max_delay_ns != 0 &&
+			__rte_ring_now_ns() - p->oldest_ns >= p->max_delay_ns)
+			return rte_ring_producer_flush(p);
+		return p->count;
+	}
+
+	/**
+	* Stage one object, flushing when the threshold is reached, or the
+	* delay once it is checked.
+	*
+	* @param p
+	*   A staging buffer.
+	* @param obj
+	*   A pointer to the object, of the ring element size.
+	* @return
+	*   1 if the object was taken, 0 if the buffer is full and the ring
+	*   has no room for any of it.
+	*/
+	static inline int
+		rte_ring_producer_enqueue(struct rte_ring_producer *p, const void *obj)
+	{
+		const size_t esize = p->r->elemlen;
+
+		if (unlikely(p->count == p->threshold) &&
+			rte_ring_producer_flush(p) == p->threshold)
+			return 0;
+
+		if (p->count == 0 && p->max_delay_ns != 0)
+			p->oldest_ns = __rte_ring_now_ns();
+		memcpy(p->buf + p->count * esize, obj, esize);
+		if (++p->count == p->threshold)
+			rte_ring_producer_flush(p);
+		else if ((p->count & (RTE_RING_PRODUCER_CHECK - 1)) == 0)
+			rte_ring_producer_poll(p);
+		return 1;
+	}
+
+	/**
+	* Free a staging buffer. Objects still staged are dropped, so flush
+	* first.
+	*
+	* @param p
+	*   Buffer to free
+	*/
+	static inline void
+		rte_ring_producer_free(struct rte_ring_producer *p)
+	{
+		free(p);
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_PRODUCER_H_ */
@@ -0,0 +1,324 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_SET_H_
+#define _RTE_RING_SET_H_
+
+/**
+* @file
+* RTE Ring sets
+*
+* Lets one consumer serve many rings without reading the indexes of the
+* idle ones. A set is a readiness bitmap in a shared memory, with one bit
+* per ring, that producers set after publishing into an empty ring:
+*
+*   consumer:  s = rte_ring_set_create(p, len);
+*              rte_ring_set_add(s, 0, urgent, 1);
+*              rte_ring_set_add(s, 1, bulk, 32);
+*              n = rte_ring_set_dequeue_wrr(s, objs, 32, &id);
+*   producer:  s = rte_ring_set_attach(p);
+*              rte_ring_set_add(s, 1, bulk, 0);
+*              rte_ring_enqueue_burst(bulk, objs, n, NULL);
+*
+* Once a ring is added to a set in a process, an enqueue on it in that
+* process that finds it empty checks its bit, and sets it only if it is
+* clear; enqueues behind unconsumed objects leave the bitmap alone. The
+* consumer clears the bit before it dequeues, and sets it again if it
+* leaves objects or sees a producer head ahead of it, so a ring is never
+* left non-empty with its bit clear. Rings
+* are served in id order by rte_ring_set_dequeue_prio(), or in turn by
+* rte_ring_set_dequeue_wrr(), up to the weight of each ring per turn.
+*
+* A set has a single consumer thread. Its rings must be regular rings
+* (not broadcast, lossy or message rings).
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rte_ring.h"
+
+#ifndef RTE_RING_SET_MAX
+#define RTE_RING_SET_MAX 256 /**< Rings per set, a multiple of 64 */
+#endif
+#define RTE_RING_SET_WORDS (RTE_RING_SET_MAX / 64)
+#define RTE_RING_SET_MAGIC 0x53455452 /**< "RTES" */
+
+	/** Shared memory of a ring set. */
+	struct rte_ring_set_shm {
+		uint32_t magic;          /**< RTE_RING_SET_MAGIC */
+		uint32_t max;            /**< RTE_RING_SET_MAX of the creator */
+		uint32_t init_done;      /**< Non-zero once the set is usable */
+		/** Bit id is set when ring id may hold objects */
+		uint64_t ready[RTE_RING_SET_WORDS] __attribute__((aligned(RTE_RING_INDEX_PAD)));
+	} __attribute__((aligned(RTE_RING_INDEX_PAD)));
+
+	/** Process-local view of a ring set. */
+	struct rte_ring_set {
+		struct rte_ring_set_shm *shm;
+		uint32_t next;           /**< Next id served by round robin */
+		struct rte_ring *rings[RTE_RING_SET_MAX]; /**< Added rings */
+		uint32_t weight[RTE_RING_SET_MAX]; /**< Objects per turn */
+	};
+
+	/** Size of the shared memory needed by a ring set. */
+	static inline size_t
+		rte_ring_set_get_memsize(void)
+	{
+		return sizeof(struct rte_ring_set_shm);
+	}
+
+	/** @internal Allocate the local view of the set in p. */
+	static inline struct rte_ring_set *
+		__rte_ring_set_alloc(void *p)
+	{
+		struct rte_ring_set *s;
+
+		s = (struct rte_ring_set *)calloc(1, sizeof(*s));
+		if (s == NULL)
+			return NULL;
+		s->shm = (struct rte_ring_set_shm *)p;
+		return s;
+	}
+
+	/**
+	* Create a new, empty ring set in a shared memory.
+	*
+	* @param p
+	*  A pointer to a shared memory, aligned on RTE_RING_INDEX_PAD
+	* @param totallen
+	*  size of the shared memory, at least rte_ring_set_get_memsize()
+	* @return
+	*   The set, to be freed with rte_ring_set_free(), or NULL on error.
+	*/
+	static inline struct rte_ring_set *
+		rte_ring_set_create(void *p, size_t totallen)
+	{
+		struct rte_ring_set *s;
+
+		if (totallen < rte_ring_set_get_memsize())
+			return NULL;
+		s = __rte_ring_set_alloc(p);
+		if (s == NULL)
+			return NULL;
+		memset(p, 0, sizeof(struct rte_ring_set_shm));
+		s->shm->magic = RTE_RING_SET_MAGIC;
+		s->shm->max = RTE_RING_SET_MAX;
+		__atomic_store_n(&s->shm->init_done, 1, __ATOMIC_RELEASE);
+		return s;
+	}
+
+	/**
+	* Map an existing ring set, e.g. from a producer process.
+	*
+	* @return
+	*   The set, or NULL if p does not hold an initialized set.
+	*/
+	static inline struct rte_ring_set *
+		rte_ring_set_attach(void *p)
+	{
+		const struct rte_ring_set_shm *shm = (const struct rte_ring_set_shm *)p;
+
+		if (__atomic_load_n(&shm->init_done, __ATOMIC_ACQUIRE) == 0 ||
+			shm->magic != RTE_RING_SET_MAGIC ||
+			shm->max != RTE_RING_SET_MAX)
+			return NULL;
+		return __rte_ring_set_alloc(p);
+	}
+
+	/**
+	* Add a ring to the set in this process, as ring id. Producers must do
+	* it in each process before they enqueue; the consumer does it to
+	* serve the ring. The ring is marked ready, in case it already holds
+	* objects.
+	*
+	* @param s
+	*   A ring set.
+	* @param id
+	*   Number of the ring in the set, below RTE_RING_SET_MAX; lower ids
+	*   come first in rte_ring_set_dequeue_prio().
+	* @param r
+	*   The ring, in this process.
+	* @param weight
+	*   Most objects dequeued from it per turn of rte_ring_set_dequeue_wrr();
+	*   not used by producers.
+	* @return
+	*   0, or -1 if id is out of range.
+	*/
+	static inline int
+		rte_ring_set_add(struct rte_ring_set *s, unsigned int id,
+			struct rte_ring *r, unsigned int weight)
+	{
+		if (id >= RTE_RING_SET_MAX)
+			return -1;
+		s->rings[id] = r;
+		s->weight[id] = weight == 0 ? 1 : weight;
+		r->ready_bit = 1ULL << (id % 64);
+		__atomic_store_n(&r->ready_word, &s->shm->ready[id / 64],
+			__ATOMIC_RELEASE);
+		__rte_ring_notify(r);
+		return 0;
+	}
+
+	/**
+	* Stop notifying the set about a ring in this process.
+	*/
+	static inline void
+		rte_ring_set_del(struct rte_ring_set *s, unsigned int id)
+	{
+		if (id >= RTE_RING_SET_MAX || s->rings[id] == NULL)
+			return;
+		__atomic_store_n(&s->rings[id]->ready_word, NULL, __ATOMIC_RELEASE);
+		s->rings[id] = NULL;
+	}
+
+	/**
+	* Free the local view of a set, after rte_ring_set_del() of its rings.
+	* The shared memory is left untouched.
+	*/
+	static inline void
+		rte_ring_set_free(struct rte_ring_set *s)
+	{
+		free(s);
+	}
+
+	/**
+	* List the rings that may hold objects, in id order, without
+	* reading any ring. Only the bitmap line is read.
+	*
+	* @param s
+	*   A ring set.
+	* @param ids
+	*   Filled with the ids of the ready rings.
+	* @param max
+	*   Size of ids.
+	* @return
+	*   The number of ids filled.
+	*/
+	static inline unsigned int
+		rte_ring_set_poll(const struct rte_ring_set *s, unsigned int *ids,
+			unsigned int max)
+	{
+		unsigned int w, n = 0;
+		uint64_t bits;
+
+		for (w = 0; w < RTE_RING_SET_WORDS && n < max; w++) {
+			bits = __atomic_load_n(&s->shm->ready[w], __ATOMIC_RELAXED);
+			for (; bits != 0 && n < max; bits &= bits - 1)
+				ids[n++] = w * 64 + __builtin_ctzll(bits);
+		}
+		return n;
+	}
+
+	/**
+	* Dequeue up to n objects from ring id of the set, keeping its ready
+	* bit right: cleared if the ring is left empty, set otherwise.
+	*
+	* @return
+	*   - n: Actual number of objects dequeued.
+	*/
+	static inline unsigned int
+		rte_ring_set_dequeue_id(struct rte_ring_set *s, unsigned int id,
+			void *obj_table, unsigned int n)
+	{
+		volatile uint64_t *word = &s->shm->ready[id / 64];
+		const uint64_t bit = 1ULL << (id % 64);
+		struct rte_ring *r = s->rings[id];
+		unsigned int ret, available;
+
+		__atomic_fetch_and(word, ~bit, __ATOMIC_RELAXED);
+		/* pairs with the fence in __rte_ring_notify() */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (unlikely(r == NULL))
+			return 0;
+		ret = rte_ring_dequeue_burst(r, obj_table, n, &available);
+		if (available != 0) {
+			__atomic_fetch_or(word, bit, __ATOMIC_RELAXED);
+		} else {
+			/*
+			 * A producer that reserved behind the objects just drained
+			 * did not notify (see __rte_ring_notify_enq()): catch its
+			 * head move instead.
+			 */
+			__atomic_thread_fence(__ATOMIC_SEQ_CST);
+			if (__atomic_load_n(r->prod_head, __ATOMIC_RELAXED) !=
+				__atomic_load_n(r->cons_head, __ATOMIC_RELAXED))
+				__atomic_fetch_or(word, bit, __ATOMIC_RELAXED);
+		}
+		return ret;
+	}
+
+	/**
+	* @internal Serve the first ready ring from id start on, wrapping
+	* around, with at most n objects, or its weight if wrr is set.
+	*/
+	static inline unsigned int
+		__rte_ring_set_dequeue(struct rte_ring_set *s, unsigned int start,
+			void *obj_table, unsigned int n, int wrr, unsigned int *id)
+	{
+		unsigned int i, w, ret;
+		uint64_t bits;
+
+		for (i = 0; i <= RTE_RING_SET_WORDS; i++) {
+			w = (start / 64 + i) % RTE_RING_SET_WORDS;
+			bits = __atomic_load_n(&s->shm->ready[w], __ATOMIC_RELAXED);
+			/* the first word is scanned from start, then its low bits last */
+			if (i == 0)
+				bits &= ~0ULL << (start % 64);
+			else if (i == RTE_RING_SET_WORDS)
+				bits &= ~(~0ULL << (start % 64));
+			for (; bits != 0; bits &= bits - 1) {
+				*id = w * 64 + __builtin_ctzll(bits);
+				ret = rte_ring_set_dequeue_id(s, *id, obj_table,
+					wrr && s->weight[*id] < n ? s->weight[*id] : n);
+				if (ret != 0)
+					return ret;
+			}
+		}
+		return 0;
+	}
+
+	/**
+	* Dequeue up to n objects from the ready ring with the lowest id.
+	*
+	* @param s
+	*   A ring set.
+	* @param obj_table
+	*   A pointer to a table of objects that will be filled, of the element
+	*   size of the ring returned in id.
+	* @param n
+	*   The maximum number of objects to dequeue.
+	* @param id
+	*   Returns the ring the objects come from.
+	* @return
+	*   - n: Actual number of objects dequeued, 0 if all rings are empty.
+	*/
+	static inline unsigned int
+		rte_ring_set_dequeue_prio(struct rte_ring_set *s, void *obj_table,
+			unsigned int n, unsigned int *id)
+	{
+		return __rte_ring_set_dequeue(s, 0, obj_table, n, 0, id);
+	}
+
+	/**
+	* Dequeue from the next ready ring in turn, up to n objects and the
+	* ring weight. Parameters are those of rte_ring_set_dequeue_prio().
+	*/
+	static inline unsigned int
+		rte_ring_set_dequeue_wrr(struct rte_ring_set *s, void *obj_table,
+			unsigned int n, unsigned int *id)
+	{
+		unsigned int ret;
+
+		ret = __rte_ring_set_dequeue(s, s->next, obj_table, n, 1, id);
+		if (ret != 0)
+			s->next = (*id + 1) % RTE_RING_SET_MAX;
+		return ret;
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_SET_H_ */
@@ -0,0 +1,397 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_SHM_H_
+#define _RTE_RING_SHM_H_
+
+/**
+* @file
+* RTE Ring shared memory allocator
+*
+* Creates rings in named POSIX shared memory, so that several processes
+* can use them:
+*
+*   creator:  r = rte_ring_create_shm("/feed", 4096, 64, SOCKET_ID_ANY,
+*                     RING_F_POW2_SZ | RING_F_SHM_HUGE | RING_F_SHM_LOCK);
+*   others:   r = rte_ring_attach_shm("/feed");
+*   all:      rte_ring_free_shm(r);
+*   last one: rte_ring_unlink_shm("/feed");
+*
+* With RING_F_SHM_HUGE the ring is backed by a file in the hugetlbfs mount
+* RTE_RING_HUGEPAGE_DIR, using the page size of that mount (2 MB or 1 GB).
+* If no hugetlbfs is mounted there, or it has too few free huge pages for
+* the ring, regular shm is used and transparent huge pages are requested
+* with madvise().
+*
+* The whole mapping is faulted in at creation, after it is bound to the
+* requested NUMA node, so the hot path never takes a first-touch fault.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <sys/syscall.h>
+
+#include "rte_ring.h"
+
+#ifndef RTE_RING_HUGEPAGE_DIR
+#define RTE_RING_HUGEPAGE_DIR "/dev/hugepages" /**< hugetlbfs mount point */
+#endif
+
+#define RTE_RING_HUGETLBFS_MAGIC 0x958458f6
+#define RTE_RING_MPOL_BIND 2     /**< MPOL_BIND from <numaif.h> */
+
+#define SOCKET_ID_ANY -1         /**< No NUMA binding */
+
+#define RING_F_SHM_HUGE 0x0100   /**< Back the ring with huge pages */
+#define RING_F_SHM_LOCK 0x0200   /**< mlock() the ring in every process */
+
+	/**
+	* @internal Open the file backing a ring, in hugetlbfs if huge is set
+	* and a hugetlbfs is mounted, else in POSIX shm. Falls back to POSIX shm
+	* only if the file is not in hugetlbfs or hugetlbfs has no room to
+	* create it; a lack of huge pages shows later, when the file is mapped,
+	* and is handled by rte_ring_create_shm_numa(). With O_EXCL, a name
+	* taken in either place fails with EEXIST, since rte_ring_attach_shm()
+	* and rte_ring_unlink_shm() look in hugetlbfs first.
+	*
+	* @param pgsz
+	*   Returns the page size of the backing file system.
+	* @param hugetlbfs
+	*   Returns 1 if the file is in hugetlbfs.
+	*/
+	static inline int
+		__rte_ring_shm_open(const char *name, int oflag, int huge,
+			size_t *pgsz, int *hugetlbfs)
+	{
+		char path[PATH_MAX];
+		struct statfs sfs;
+		int fd;
+
+		while (*name == '/')
+			name++;
+
+		snprintf(path, sizeof(path), "%s/%s", RTE_RING_HUGEPAGE_DIR, name);
+		if (huge && statfs(RTE_RING_HUGEPAGE_DIR, &sfs) == 0 &&
+			sfs.f_type == RTE_RING_HUGETLBFS_MAGIC) {
+			fd = open(path, oflag, 0600);
+			if (fd >= 0) {
+				*pgsz = sfs.f_bsize;
+				*hugetlbfs = 1;
+				return fd;
+			}
+			if (errno != ENOENT && errno != ENOMEM && errno != ENOSPC)
+				return -1;
+		} else if ((oflag & O_EXCL) && access(path, F_OK) == 0) {
+			errno = EEXIST;
+			return -1;
+		}
+
+		snprintf(path, sizeof(path), "/%s", name);
+		*pgsz = sysconf(_SC_PAGESIZE);
+		*hugetlbfs = 0;
+		return shm_open(path, oflag, 0600);
+	}
+
+	/**
+	* @internal Bind a mapping to one NUMA node, before it is faulted in.
+	*/
+	static inline int
+		__rte_ring_mbind(void *p, size_t len, int socket_id)
+	{
+		unsigned long nodemask;
+
+		if (socket_id == SOCKET_ID_ANY)
+			return 0;
+		if (socket_id < 0 || socket_id >= (int)(8 * sizeof(nodemask))) {
+			errno = EINVAL;
+			return -1;
+		}
+		nodemask = 1UL << socket_id;
+		return (int)syscall(SYS_mbind, p, len, RTE_RING_MPOL_BIND,
+			&nodemask, 8 * sizeof(nodemask) + 1, 0);
+	}
+
+	/**
+	* @internal Bind the pages of a ring holding its header to hdr_socket,
+	* and the pages holding only ring data to data_socket.
+	*
+	* The four head/tail lines lie in the first 4 * RTE_RING_INDEX_PAD bytes,
+	* always within one page, so they cannot be split between two nodes:
+	* the consumer lines go with the producer ones to hdr_socket.
+	*/
+	static inline int
+		__rte_ring_mbind_split(void *p, size_t len, size_t pgsz,
+			int hdr_socket, int data_socket)
+	{
+		size_t hdr_len = (RTE_RING_HDR_SIZE + pgsz - 1) / pgsz * pgsz;
+
+		if (hdr_len > len)
+			hdr_len = len;
+		if (__rte_ring_mbind(p, hdr_len, hdr_socket) < 0)
+			return -1;
+		if (hdr_len == len)
+			return 0;
+		return __rte_ring_mbind((char *)p + hdr_len, len - hdr_len,
+			data_socket);
+	}
+
+	/**
+	* Place the memory of a ring that is not yet faulted in, before
+	* rte_ring_create(): the header page, with the head and tail lines, on
+	* the producer node, and the rest of the ring on the consumer node.
+	*
+	* The consumer head and tail share the header page, so when the nodes
+	* differ the consumers update them in remote memory while the producers
+	* keep theirs local: one page cannot hold both sides close to their
+	* threads.
+	*
+	* @param p
+	*   A page aligned mapping, not yet touched.
+	* @param len
+	*   Length of the mapping.
+	* @param prod_socket
+	*   NUMA node of the producers, or SOCKET_ID_ANY.
+	* @param cons_socket
+	*   NUMA node of the consumers, or SOCKET_ID_ANY.
+	* @return
+	*   0 on success, -1 with errno set otherwise.
+	*/
+	static inline int
+		rte_ring_numa_bind(void *p, size_t len, int prod_socket, int cons_socket)
+	{
+		return __rte_ring_mbind_split(p, len, sysconf(_SC_PAGESIZE),
+			prod_socket, cons_socket);
+	}
+
+	/**
+	* NUMA node of the calling thread, from the CPU it runs on now.
+	*
+	* @return
+	*   The node, or SOCKET_ID_ANY if it is unknown.
+	*/
+	static inline int
+		rte_ring_socket_id(void)
+	{
+		unsigned int cpu, node;
+
+		if (syscall(SYS_getcpu, &cpu, &node, NULL) < 0)
+			return SOCKET_ID_ANY;
+		return (int)node;
+	}
+
+	/**
+	* Remove the named shared memory of a ring. Processes that still have it
+	* mapped keep using it.
+	*
+	* @return
+	*   0 on success, -1 with errno set otherwise.
+	*/
+	static inline int
+		rte_ring_unlink_shm(const char *name)
+	{
+		char path[PATH_MAX];
+
+		while (*name == '/')
+			name++;
+		snprintf(path, sizeof(path), "%s/%s", RTE_RING_HUGEPAGE_DIR, name);
+		if (unlink(path) == 0)
+			return 0;
+		snprintf(path, sizeof(path), "/%s", name);
+		return shm_unlink(path);
+	}
+
+	/**
+	* Create a new ring in a named shared memory, split between the NUMA
+	* nodes of its producers and of its consumers: the data, which the
+	* consumers read, lives on cons_socket, and the header page, with the
+	* head and tail lines, on prod_socket. Pages holding both go with the
+	* header. See rte_ring_numa_bind() for the consumer lines.
+	*
+	* @param name
+	*   Name of the shared memory; fails with EEXIST if it already exists.
+	* @param count
+	*   Number of slots of the ring; with RING_F_POW2_SZ or RING_F_SLOT_SEQ
+	*   it should be a power of two, else it is rounded down.
+	* @param elemlen
+	*   size of the element
+	* @param prod_socket
+	*   NUMA node of the producers, or SOCKET_ID_ANY.
+	* @param cons_socket
+	*   NUMA node of the consumers, or SOCKET_ID_ANY.
+	* @param flags
+	*   Flags of rte_ring_create_shm().
+	* @return
+	*   The ring, or NULL with errno set on error, EINVAL if it needs more
+	*   than INT_MAX bytes.
+	*/
+	static inline struct rte_ring *
+		rte_ring_create_shm_numa(const char *name, unsigned int count,
+			unsigned int elemlen, int prod_socket, int cons_socket,
+			unsigned int flags)
+	{
+		const size_t len = (flags & RING_F_SLOT_SEQ) ?
+			rte_ring_slot_seq_get_memsize(count, elemlen) :
+			rte_ring_get_memsize(count, elemlen);
+		size_t pgsz, map_len;
+		int fd, hugetlbfs, err;
+		int huge = flags & RING_F_SHM_HUGE;
+		struct rte_ring *r;
+		void *p;
+
+		/* rte_ring_create() takes the length as an int */
+		if (count == 0 || elemlen == 0 || len > INT_MAX) {
+			errno = EINVAL;
+			return NULL;
+		}
+
+	retry:
+		fd = __rte_ring_shm_open(name, O_CREAT | O_EXCL | O_RDWR, huge,
+			&pgsz, &hugetlbfs);
+		if (fd < 0)
+			return NULL;
+
+		map_len = (len + pgsz - 1) / pgsz * pgsz;
+		p = MAP_FAILED;
+		if (ftruncate(fd, map_len) == 0)
+			p = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+				fd, 0);
+		err = errno;
+		close(fd);
+		if (p == MAP_FAILED) {
+			/* hugetlbfs reserves the pages here: without free ones, use shm */
+			if (hugetlbfs &&
+				(err == ENOMEM || err == ENOSPC || err == EINVAL)) {
+				rte_ring_unlink_shm(name);
+				huge = 0;
+				goto retry;
+			}
+			goto fail_unlink;
+		}
+
+		if ((flags & RING_F_SHM_HUGE) && !hugetlbfs)
+			madvise(p, map_len, MADV_HUGEPAGE);
+		if (__rte_ring_mbind_split(p, map_len, pgsz, prod_socket,
+				cons_socket) < 0 ||
+			((flags & RING_F_SHM_LOCK) && mlock(p, map_len) < 0)) {
+			err = errno;
+			munmap(p, map_len);
+			goto fail_unlink;
+		}
+
+		/* rte_ring_create() writes the whole ring, which prefaults it */
+		r = rte_ring_create(p, (int)len, (int)elemlen, flags);
+		if (r == NULL) {
+			/* allocation failure or a rejected flag combination */
+			err = EINVAL;
+			munmap(p, map_len);
+			goto fail_unlink;
+		}
+		r->map_len = map_len;
+		return r;
+
+	fail_unlink:
+		rte_ring_unlink_shm(name);
+		errno = err;
+		return NULL;
+	}
+
+	/**
+	* Create a new ring in a named shared memory of exactly the needed size.
+	*
+	* @param name
+	*   Name of the shared memory; fails with EEXIST if it already exists.
+	* @param count
+	*   Number of slots of the ring; with RING_F_POW2_SZ it should be a power
+	*   of two, else it is rounded down.
+	* @param elemlen
+	*   size of the element
+	* @param socket_id
+	*   NUMA node to allocate the ring on, or SOCKET_ID_ANY.
+	* @param flags
+	*   Flags of rte_ring_create(), plus:
+	*   - RING_F_SHM_HUGE: use huge pages when available.
+	*   - RING_F_SHM_LOCK: lock the pages in memory. The flag is recorded in
+	*     the ring, so rte_ring_attach_shm() locks them too.
+	* @return
+	*   The ring, or NULL with errno set on error.
+	*/
+	static inline struct rte_ring *
+		rte_ring_create_shm(const char *name, unsigned int count,
+			unsigned int elemlen, int socket_id, unsigned int flags)
+	{
+		return rte_ring_create_shm_numa(name, count, elemlen, socket_id,
+			socket_id, flags);
+	}
+
+	/**
+	* Unmap a ring from rte_ring_create_shm() or rte_ring_attach_shm() and
+	* free it. The shared memory itself stays until rte_ring_unlink_shm().
+	*/
+	static inline void
+		rte_ring_free_shm(struct rte_ring *r)
+	{
+		munmap((void *)r->prod_head, r->map_len);
+		rte_ring_free(r);
+	}
+
+	/**
+	* Map a ring created by rte_ring_create_shm(), possibly in another
+	* process. The pages are faulted in, and locked if the ring was created
+	* with RING_F_SHM_LOCK.
+	*
+	* @return
+	*   The ring, or NULL with errno set on error.
+	*/
+	static inline struct rte_ring *
+		rte_ring_attach_shm(const char *name)
+	{
+		size_t pgsz;
+		int fd, hugetlbfs;
+		struct rte_ring *r;
+		struct stat st;
+		void *p;
+
+		fd = __rte_ring_shm_open(name, O_RDWR, 1, &pgsz, &hugetlbfs);
+		if (fd < 0)
+			return NULL;
+		if (fstat(fd, &st) < 0) {
+			close(fd);
+			return NULL;
+		}
+		p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd, 0);
+		close(fd);
+		if (p == MAP_FAILED)
+			return NULL;
+
+		r = rte_ring_attach(p);
+		if (r == NULL) {
+			munmap(p, st.st_size);
+			errno = EINVAL;
+			return NULL;
+		}
+		r->map_len = st.st_size;
+		if ((r->flags & RING_F_SHM_LOCK) && mlock(p, r->map_len) < 0) {
+			const int err = errno;
+
+			rte_ring_free_shm(r);
+			errno = err;
+			return NULL;
+		}
+		return r;
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_SHM_H_ */
@@ -0,0 +1,129 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_TRACE_H_
+#define _RTE_RING_TRACE_H_
+
+/**
+* @file
+* RTE Ring tracing
+*
+* Opt-in tracing of ring operations. Build with -DRTE_RING_TRACE to enable
+* it; by default every trace point compiles to nothing.
+*
+* When enabled, each enqueue/dequeue writes one fixed-size binary record
+* into a per-thread circular buffer. Nothing is formatted and no lock is
+* taken on the hot path; records are decoded later with
+* rte_ring_trace_dump().
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+	/** Trace event types */
+	enum rte_ring_trace_event {
+		RTE_RING_TRACE_ENQ = 1, /**< enqueue; n == 0 means ring was full */
+		RTE_RING_TRACE_DEQ,     /**< dequeue; n == 0 means ring was empty */
+	};
+
+	/** One trace record, 32 bytes. */
+	struct rte_ring_trace_rec {
+		uint64_t tsc;            /**< Time stamp counter at the event */
+		const void *ring;        /**< Ring the event was recorded on */
+		uint32_t event;          /**< One of enum rte_ring_trace_event */
+		uint32_t head;           /**< Head value where the operation starts */
+		uint32_t n;              /**< Number of objects moved */
+		uint32_t reserved;
+	};
+
+#ifdef RTE_RING_TRACE
+
+#include <x86intrin.h>
+
+#ifndef RTE_RING_TRACE_DEPTH
+#define RTE_RING_TRACE_DEPTH 4096 /**< Records per thread, power of two */
+#endif
+
+	/** Per-thread trace buffer. Oldest records are overwritten. */
+	struct rte_ring_trace_buf {
+		uint64_t count;          /**< Records written since last reset */
+		struct rte_ring_trace_rec rec[RTE_RING_TRACE_DEPTH];
+	};
+
+	static __thread struct rte_ring_trace_buf rte_ring_trace_buf;
+
+	static inline __attribute__((always_inline)) void
+		__rte_ring_trace(const void *r, uint32_t event, uint32_t head,
+			uint32_t n)
+	{
+		struct rte_ring_trace_rec *rec = &rte_ring_trace_buf.rec[
+			rte_ring_trace_buf.count++ & (RTE_RING_TRACE_DEPTH - 1)];
+
+		rec->tsc = __rdtsc();
+		rec->ring = r;
+		rec->event = event;
+		rec->head = head;
+		rec->n = n;
+	}
+
+#define RTE_RING_TRACE_EVENT(r, event, head, n) \
+	__rte_ring_trace((r), (event), (head), (n))
+
+	/**
+	* Reset the calling thread's trace buffer.
+	*/
+	static inline void
+		rte_ring_trace_reset(void)
+	{
+		rte_ring_trace_buf.count = 0;
+	}
+
+	/**
+	* Write the calling thread's trace records, oldest first, as text.
+	*
+	* @param f
+	*   Output stream.
+	*/
+	static inline void
+		rte_ring_trace_dump(FILE *f)
+	{
+		uint64_t i = 0;
+		const struct rte_ring_trace_rec *rec;
+
+		if (rte_ring_trace_buf.count > RTE_RING_TRACE_DEPTH)
+			i = rte_ring_trace_buf.count - RTE_RING_TRACE_DEPTH;
+		for (; i < rte_ring_trace_buf.count; i++) {
+			rec = &rte_ring_trace_buf.rec[i & (RTE_RING_TRACE_DEPTH - 1)];
+			fprintf(f, "%" PRIu64 " %p %s head:%u n:%u\n", rec->tsc,
+				rec->ring, rec->event == RTE_RING_TRACE_ENQ ?
+				"enq" : "deq", rec->head, rec->n);
+		}
+	}
+
+#else
+
+#define RTE_RING_TRACE_EVENT(r, event, head, n) do { } while (0)
+
+	static inline void
+		rte_ring_trace_reset(void)
+	{
+	}
+
+	static inline void
+		rte_ring_trace_dump(FILE *f)
+	{
+		(void)f;
+	}
+
+#endif /* RTE_RING_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_TRACE_H_ */
@@ -0,0 +1,166 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#ifndef _RTE_RING_WAIT_H_
+#define _RTE_RING_WAIT_H_
+
+/**
+* @file
+* RTE Ring blocking API
+*
+* Lets consumers block until objects arrive and producers block until room
+* is freed, instead of busy polling. A waiter first spins for
+* RTE_RING_WAIT_SPIN pauses, then registers in the waiter count kept next
+* to the tail it waits on and sleeps on that tail with a futex. The other
+* side only makes a wake system call when the waiter count is non-zero.
+*
+* The futexes are not private, so this works across processes sharing the
+* ring. The ring must be created with RING_F_WAIT for the other side to
+* issue wakeups; without it, waiting degrades to spinning until the
+* timeout.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <errno.h>
+#include <time.h>
+
+#include "rte_ring.h"
+
+/** Wait without timeout. */
+#define RTE_RING_WAIT_FOREVER UINT64_MAX
+
+#ifndef RTE_RING_WAIT_SPIN
+#define RTE_RING_WAIT_SPIN 1024 /**< Pauses before going to sleep */
+#endif
+
+	/**
+	* @internal Deadline timeout_ns from now, RTE_RING_WAIT_FOREVER if it
+	* does not fit.
+	*/
+	static inline uint64_t
+		__rte_ring_wait_deadline(uint64_t timeout_ns)
+	{
+		const uint64_t now = __rte_ring_now_ns();
+
+		if (timeout_ns >= RTE_RING_WAIT_FOREVER - now)
+			return RTE_RING_WAIT_FOREVER;
+		return now + timeout_ns;
+	}
+
+	/**
+	* @internal Wait until a tail moves away from seen, or deadline passes.
+	*
+	* @return
+	*   0 if the tail may have moved, -ETIMEDOUT once the deadline passed.
+	*/
+	static inline int
+		__rte_ring_wait_tail(struct rte_ring *r, volatile rte_ring_idx_t *tail,
+			volatile uint32_t *waiters, rte_ring_idx_t seen, uint64_t deadline)
+	{
+		struct timespec ts, *tsp = NULL;
+		uint64_t now;
+		unsigned int i;
+
+		for (i = 0; i < RTE_RING_WAIT_SPIN; i++) {
+			if (__atomic_load_n(tail, __ATOMIC_ACQUIRE) != seen)
+				return 0;
+			_mm_pause();
+		}
+
+		if (deadline != RTE_RING_WAIT_FOREVER) {
+			now = __rte_ring_now_ns();
+			if (now >= deadline)
+				return -ETIMEDOUT;
+			ts.tv_sec = (deadline - now) / 1000000000ULL;
+			ts.tv_nsec = (deadline - now) % 1000000000ULL;
+			tsp = &ts;
+		}
+		if (!(r->flags & RING_F_WAIT))
+			return 0;
+
+		/* pairs with the fence in __rte_ring_wake() */
+		__atomic_fetch_add(waiters, 1, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(tail, __ATOMIC_SEQ_CST) == seen)
+			syscall(SYS_futex, tail, FUTEX_WAIT, (uint32_t)seen, tsp, NULL, 0);
+		__atomic_fetch_sub(waiters, 1, __ATOMIC_RELEASE);
+		return 0;
+	}
+
+	/**
+	* Dequeue up to n objects, blocking until at least one is available.
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	* @param obj_table
+	*   A pointer to a table of void * pointers (objects) that will be filled.
+	* @param n
+	*   The maximum number of objects to dequeue.
+	* @param timeout_ns
+	*   How long to wait, or RTE_RING_WAIT_FOREVER.
+	* @return
+	*   - n: Actual number of objects dequeued, 0 on timeout.
+	*/
+	static inline unsigned int
+		rte_ring_dequeue_wait(struct rte_ring *r, void *obj_table,
+			unsigned int n, uint64_t timeout_ns)
+	{
+		const uint64_t deadline = __rte_ring_wait_deadline(timeout_ns);
+		unsigned int ret;
+		rte_ring_idx_t seen;
+
+		for (;;) {
+			seen = __atomic_load_n(r->prod_tail, __ATOMIC_ACQUIRE);
+			ret = rte_ring_dequeue_burst(r, obj_table, n, NULL);
+			if (ret != 0 || n == 0)
+				return ret;
+			if (__rte_ring_wait_tail(r, r->prod_tail, r->prod_waiters,
+					seen, deadline) < 0)
+				return 0;
+		}
+	}
+
+	/**
+	* Enqueue n objects, blocking until there is room for all of them.
+	*
+	* @param r
+	*   A pointer to the ring structure.
+	* @param obj_table
+	*   A pointer to a table of void * pointers (objects).
+	* @param n
+	*   The number of objects to add in the ring from the obj_table.
+	* @param timeout_ns
+	*   How long to wait, or RTE_RING_WAIT_FOREVER.
+	* @return
+	*   The number of objects enqueued, either n, or 0 on timeout or if n is
+	*   larger than the ring capacity.
+	*/
+	static inline unsigned int
+		rte_ring_enqueue_wait(struct rte_ring *r, void *obj_table,
+			unsigned int n, uint64_t timeout_ns)
+	{
+		const uint64_t deadline = __rte_ring_wait_deadline(timeout_ns);
+		unsigned int ret;
+		rte_ring_idx_t seen;
+
+		if (n > r->capacity)
+			return 0;
+
+		for (;;) {
+			seen = __atomic_load_n(r->cons_tail, __ATOMIC_ACQUIRE);
+			ret = rte_ring_enqueue_bulk(r, obj_table, n, NULL);
+			if (ret != 0 || n == 0)
+				return ret;
+			if (__rte_ring_wait_tail(r, r->cons_tail, r->cons_waiters,
+					seen, deadline) < 0)
+				return 0;
+		}
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_WAIT_H_ */